@@ -0,0 +1,192 @@
+#include <stdint.h>
+#include <time.h>
+
+#include "toothpaste.h"
+
+/*
+ * An adaptive uitoa: it watches what it is asked to convert and switches to whichever engine the cost model
+ * says is cheapest for that mix.
+ *
+ * Every call adds the input's bit length and popcount to its site's running sums (a handful of instructions).
+ * Every `repickInterval` calls the site re-evaluates, for each engine,
+ *     cost = fixed + perBit * mean bit length + perSetBit * mean popcount
+ * and keeps the cheapest. The sums are then halved, so older traffic fades out and a site follows its
+ * distribution when it drifts.
+ *
+ * The coefficients start as rough estimates. tp_adaptive_calibrate() replaces them with measurements from
+ * the current machine: it times each engine on three probe sets (short values,
+ * sparse 32-bit values, dense 32-bit values), solves the resulting 3x3 system, and clamps negative coefficients to 0.
+ */
+
+#define repickInterval 1024
+
+typedef int (*engine_t)(uint32_t, char*);
+
+static int uitoaToothpaste(uint32_t i, char* a) {
+    return fillBuffer(uitodec(i), a);
+}
+
+static const struct {
+    const char* name;
+    engine_t convert;
+} engines[TP_ENGINE_COUNT] = {
+    [TP_ENGINE_TOOTHPASTE] = {"toothpaste", uitoaToothpaste},
+    [TP_ENGINE_SETBITS] = {"setbits", uitoa_setbits},
+    [TP_ENGINE_BYTEROM] = {"byterom", uitoa_byterom},
+    [TP_ENGINE_PAIRS] = {"pairs", uitoa_pairs},
+};
+
+// nanoseconds: fixed, per bit of length, per set bit
+static double costModel[TP_ENGINE_COUNT][3] = {
+    [TP_ENGINE_TOOTHPASTE] = {20.0, 1.5, 2.0},
+    [TP_ENGINE_SETBITS] = {18.0, 0.0, 2.5},
+    [TP_ENGINE_BYTEROM] = {24.0, 0.0, 0.0},
+    [TP_ENGINE_PAIRS] = {3.0, 0.6, 0.0},
+};
+
+static _Thread_local adaptiveSite_t threadSite;
+
+static int pickEngine(const adaptiveSite_t* site) {
+    double bitLength = (double)site->bitLengthSum / site->samples;
+    double popcount = (double)site->popcountSum / site->samples;
+    int best = 0;
+    double bestCost = 0;
+    for (int engine = 0; engine < TP_ENGINE_COUNT; engine++) {
+        double cost = costModel[engine][0] + costModel[engine][1] * bitLength + costModel[engine][2] * popcount;
+        if (engine == 0 || cost < bestCost) {
+            best = engine;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+int uitoa_adaptive_site(adaptiveSite_t* site, uint32_t i, char* a) {
+    site->bitLengthSum += i ? 32 - __builtin_clz(i) : 0;
+    site->popcountSum += __builtin_popcount(i);
+    site->samples++;
+    if (++site->sinceRepick == repickInterval) {
+        site->engine = pickEngine(site);
+        site->sinceRepick = 0;
+        site->bitLengthSum >>= 1;
+        site->popcountSum >>= 1;
+        site->samples >>= 1;
+    }
+    return engines[site->engine].convert(i, a);
+}
+
+int uitoa_adaptive(uint32_t i, char* a) {
+    return uitoa_adaptive_site(&threadSite, i, a);
+}
+
+adaptiveSite_t* tp_adaptive_thread_site(void) {
+    return &threadSite;
+}
+
+const char* tp_engine_name(int engine) {
+    return engine >= 0 && engine < TP_ENGINE_COUNT ? engines[engine].name : "unknown";
+}
+
+int tp_adaptive_tables(engineTable_t tables[TP_MAX_ENGINE_TABLES]) {
+    int count = 0;
+    tables[count++] = (engineTable_t){costModel, sizeof(costModel)};
+    tables[count++] = (engineTable_t){engines, sizeof(engines)};
+    for (int engine = 0; engine < TP_ENGINE_COUNT; engine++) {
+        engineTable_t engineTables[TP_MAX_ENGINE_TABLES];
+        int engineCount = tp_engine_tables(engine, engineTables);
+        for (int t = 0; t < engineCount; t++) {
+            int seen = 0;
+            for (int u = 0; u < count; u++) seen |= tables[u].start == engineTables[t].start;
+            if (!seen && count < TP_MAX_ENGINE_TABLES) tables[count++] = engineTables[t];
+        }
+    }
+    return count;
+}
+
+/* ---- calibration ---- */
+
+#define probeCount 4096
+#define probeRounds 16
+
+static double secondsNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// keeps the timed conversions from being optimized away
+static volatile char sink;
+
+static double nanosPerCall(engine_t convert, const uint32_t* probes) {
+    char buffer[11];
+    double start = secondsNow();
+    for (int round = 0; round < probeRounds; round++) {
+        for (int p = 0; p < probeCount; p++) {
+            convert(probes[p], buffer);
+            sink = buffer[0];
+        }
+    }
+    return (secondsNow() - start) * 1e9 / (probeRounds * probeCount);
+}
+
+// Cramer's rule for rows[r] . x = rhs[r]
+static int solve3(double rows[3][3], const double rhs[3], double x[3]) {
+    double det = rows[0][0] * (rows[1][1] * rows[2][2] - rows[1][2] * rows[2][1])
+               - rows[0][1] * (rows[1][0] * rows[2][2] - rows[1][2] * rows[2][0])
+               + rows[0][2] * (rows[1][0] * rows[2][1] - rows[1][1] * rows[2][0]);
+    if (det == 0) return -1;
+    for (int column = 0; column < 3; column++) {
+        double replaced[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) replaced[r][c] = c == column ? rhs[r] : rows[r][c];
+        }
+        x[column] = (replaced[0][0] * (replaced[1][1] * replaced[2][2] - replaced[1][2] * replaced[2][1])
+                   - replaced[0][1] * (replaced[1][0] * replaced[2][2] - replaced[1][2] * replaced[2][0])
+                   + replaced[0][2] * (replaced[1][0] * replaced[2][1] - replaced[1][1] * replaced[2][0])) / det;
+    }
+    return 0;
+}
+
+void tp_adaptive_calibrate(void) {
+    static uint32_t probes[3][probeCount];
+    double rows[3][3];
+    uint32_t state = 2463534242u;
+
+    for (int p = 0; p < probeCount; p++) {
+        uint32_t random[3];
+        for (int r = 0; r < 3; r++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            random[r] = state;
+        }
+        probes[0][p] = 0x80 | (random[0] & 0x7f);                                    // short: 8 bits
+        probes[1][p] = 0x80000000u | (1u << (random[1] % 31));                        // sparse: 2 set bits
+        probes[2][p] = ~((1u << (random[2] % 31)) | (1u << ((random[2] >> 8) % 31))); // dense: 30-31 set bits
+    }
+    for (int set = 0; set < 3; set++) {
+        uint64_t bitLength = 0, popcount = 0;
+        for (int p = 0; p < probeCount; p++) {
+            bitLength += 32 - __builtin_clz(probes[set][p]);
+            popcount += __builtin_popcount(probes[set][p]);
+        }
+        rows[set][0] = 1;
+        rows[set][1] = (double)bitLength / probeCount;
+        rows[set][2] = (double)popcount / probeCount;
+    }
+
+    for (int engine = 0; engine < TP_ENGINE_COUNT; engine++) {
+        double measured[3], coefficients[3];
+        engines[engine].convert(1, (char[11]){0}); // builds byterom's tables outside the timed region
+        for (int set = 0; set < 3; set++) measured[set] = nanosPerCall(engines[engine].convert, probes[set]);
+        if (solve3(rows, measured, coefficients)) continue;
+        // timing noise can push a small coefficient below zero, which would reward longer or denser inputs
+        for (int c = 0; c < 3; c++) costModel[engine][c] = coefficients[c] > 0 ? coefficients[c] : 0;
+    }
+}
+
+int tp_adaptive_model(int engine, double coefficients[3]) {
+    if (engine < 0 || engine >= TP_ENGINE_COUNT) return -1;
+    for (int c = 0; c < 3; c++) coefficients[c] = costModel[engine][c];
+    return 0;
+}
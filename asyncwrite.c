@@ -0,0 +1,323 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "toothpaste.h"
+
+/*
+ * Overlapped file output: the caller converts block n+1 while block n is still being written.
+ *
+ * The caller hands over a finished buffer with asyncwriter_submit and carries on converting into the next one.
+ * At most `depth` buffers are in flight (2 is double buffering, 3 triple); submit only blocks once all of them
+ * are, and each buffer comes back through the `done` callback, on the caller's own thread, when its write has
+ * completed or failed (the callback mustn't submit). Every buffer passed to submit comes back exactly once, even
+ * when submit returns -1. Every write carries its file offset, so writes may finish in any order.
+ *
+ * Writes go through io_uring, driven by raw syscalls against <linux/io_uring.h> so there's nothing to link.
+ * If the kernel has no io_uring, or refuses IORING_OP_WRITE, or TP_WRITER_PWRITE is passed, each submit is a
+ * plain pwrite instead: nothing overlaps then, but the output is the same.
+ *
+ * Overlap efficiency is the share of write time the caller didn't spend waiting: 1 - stalled / busy, where
+ * `busy` is the time at least one write was in flight and `stalled` the time spent blocked in submit or close.
+ * Completions are only noticed when the caller looks (submit, close or asyncwriter_poll), so `busy` is an
+ * overestimate unless the caller polls while it is idle. pwrite scores 0.
+ */
+
+#define maxDepth 64
+
+typedef struct {
+    int fd;
+    unsigned entries;
+    // submission ring
+    atomic_uint* sqHead;
+    atomic_uint* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    // completion ring
+    atomic_uint* cqHead;
+    atomic_uint* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+    void* sqMap;
+    void* cqMap;
+    size_t sqMapSize;
+    size_t cqMapSize;
+    size_t sqesMapSize;
+} uring_t;
+
+typedef struct {
+    const char* data;
+    size_t length;  // bytes still to write
+    uint64_t offset;
+    void* tag;
+    int inFlight;
+} pendingWrite_t;
+
+struct asyncWriter {
+    int fd;
+    int depth;
+    int useUring;
+    int hasRing;
+    int error; // first errno seen
+    uint64_t offset;
+    writeDone_t done;
+    void* context;
+    uring_t ring;
+    pendingWrite_t writes[maxDepth];
+    int inFlight;
+    double busySince;
+    asyncWriterStats_t stats;
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int uringSetup(uring_t* ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return -1;
+
+    ring->entries = params.sq_entries;
+    ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cqMapSize > ring->sqMapSize) ring->sqMapSize = ring->cqMapSize;
+        ring->cqMapSize = ring->sqMapSize;
+    }
+    ring->sqMap = mmap(NULL, ring->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqMap == MAP_FAILED) goto failed;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqMap = ring->sqMap;
+    } else {
+        ring->cqMap = mmap(NULL, ring->cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqMap == MAP_FAILED) goto unmapSq;
+    }
+    ring->sqesMapSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqesMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto unmapCq;
+
+    ring->sqHead = (atomic_uint*)((char*)ring->sqMap + params.sq_off.head);
+    ring->sqTail = (atomic_uint*)((char*)ring->sqMap + params.sq_off.tail);
+    ring->sqMask = (unsigned*)((char*)ring->sqMap + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)((char*)ring->sqMap + params.sq_off.array);
+    ring->cqHead = (atomic_uint*)((char*)ring->cqMap + params.cq_off.head);
+    ring->cqTail = (atomic_uint*)((char*)ring->cqMap + params.cq_off.tail);
+    ring->cqMask = (unsigned*)((char*)ring->cqMap + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)((char*)ring->cqMap + params.cq_off.cqes);
+    return 0;
+
+unmapCq:
+    if (ring->cqMap != ring->sqMap) munmap(ring->cqMap, ring->cqMapSize);
+unmapSq:
+    munmap(ring->sqMap, ring->sqMapSize);
+failed:
+    close(ring->fd);
+    return -1;
+}
+
+static void uringTeardown(uring_t* ring) {
+    munmap(ring->sqes, ring->sqesMapSize);
+    if (ring->cqMap != ring->sqMap) munmap(ring->cqMap, ring->cqMapSize);
+    munmap(ring->sqMap, ring->sqMapSize);
+    close(ring->fd);
+}
+
+// queues a write for slot `index` and tells the kernel; the ring has an entry per slot, so it is never full.
+// Returns -1 only when the kernel never took the entry, so the buffer is free to go back to the caller.
+static int uringWrite(asyncWriter_t* writer, int index) {
+    uring_t* ring = &writer->ring;
+    pendingWrite_t* write = &writer->writes[index];
+    unsigned tail = atomic_load_explicit(ring->sqTail, memory_order_relaxed);
+    unsigned slot = tail & *ring->sqMask;
+    struct io_uring_sqe* sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = writer->fd;
+    sqe->addr = (uintptr_t)write->data;
+    sqe->len = write->length > 1u << 30 ? 1u << 30 : (unsigned)write->length;
+    sqe->off = write->offset;
+    sqe->user_data = index;
+    ring->sqArray[slot] = slot;
+    atomic_store_explicit(ring->sqTail, tail + 1, memory_order_release);
+
+    int submitted;
+    while ((submitted = syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0)) < 0 && errno == EINTR);
+    // without SQPOLL the kernel only consumes entries inside io_uring_enter, so once it returns the head says
+    // for certain whether this one went in; if it did, its completion comes back through reapCompletions
+    if (atomic_load_explicit(ring->sqHead, memory_order_acquire) != tail) return 0;
+    // it didn't: withdraw it, or a later enter would write from a buffer the caller already has back
+    atomic_store_explicit(ring->sqTail, tail, memory_order_release);
+    if (submitted >= 0) errno = EBUSY;
+    return -1;
+}
+
+static int pwriteFully(int fd, const char* data, size_t length, uint64_t offset) {
+    while (length) {
+        ssize_t put = pwrite(fd, data, length, offset);
+        if (put < 0 && errno == EINTR) continue;
+        if (put < 0) return -1;
+        data += put;
+        length -= put;
+        offset += put;
+    }
+    return 0;
+}
+
+// hands the buffer back; `error` is 0 or the errno this write failed with
+static void finishWrite(asyncWriter_t* writer, int index, int error) {
+    pendingWrite_t* write = &writer->writes[index];
+    write->inFlight = 0;
+    if (error && !writer->error) writer->error = error;
+    if (--writer->inFlight == 0) writer->stats.busySeconds += now() - writer->busySince;
+    if (writer->done) writer->done(writer->context, write->tag, error);
+}
+
+// handles every completion that has arrived, resubmitting the rest of short writes
+static void reapCompletions(asyncWriter_t* writer) {
+    uring_t* ring = &writer->ring;
+    unsigned head = atomic_load_explicit(ring->cqHead, memory_order_relaxed);
+
+    while (head != atomic_load_explicit(ring->cqTail, memory_order_acquire)) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cqMask];
+        int index = (int)cqe->user_data;
+        int result = cqe->res;
+        int error = 0;
+        pendingWrite_t* write = &writer->writes[index];
+        atomic_store_explicit(ring->cqHead, ++head, memory_order_release);
+
+        if (result == -EINVAL || result == -EOPNOTSUPP) {
+            // a kernel without IORING_OP_WRITE: finish this one by hand and stop using the ring
+            writer->useUring = 0;
+            writer->stats.backend = "pwrite";
+            if (pwriteFully(writer->fd, write->data, write->length, write->offset) < 0) error = errno;
+        } else if (result < 0) {
+            error = -result;
+        } else if ((size_t)result < write->length && result > 0) {
+            write->data += result;
+            write->length -= result;
+            write->offset += result;
+            if (uringWrite(writer, index) == 0) continue;
+            error = errno;
+        } else if (result == 0 && write->length) {
+            error = EIO;
+        }
+        finishWrite(writer, index, error);
+    }
+}
+
+// blocks until some write completes; returns -1 if none are in flight or the wait failed
+static int waitForCompletion(asyncWriter_t* writer) {
+    double start = now();
+    int inFlight = writer->inFlight;
+    while (writer->inFlight == inFlight) {
+        if (syscall(__NR_io_uring_enter, writer->ring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            if (!writer->error) writer->error = errno;
+            return -1;
+        }
+        reapCompletions(writer);
+    }
+    writer->stats.stalledSeconds += now() - start;
+    return 0;
+}
+
+// waits out every write still in flight. A failed wait is retried rather than given up on: the ring can't be
+// unmapped while the kernel may still read one of the caller's buffers, and each buffer has to come back
+static void drainWrites(asyncWriter_t* writer) {
+    while (writer->inFlight) {
+        if (waitForCompletion(writer) < 0) reapCompletions(writer);
+    }
+}
+
+asyncWriter_t* asyncwriter_open(const char* path, int depth, int flags, writeDone_t done, void* context) {
+    asyncWriter_t* writer = calloc(1, sizeof(asyncWriter_t));
+    if (!writer) return NULL;
+    if (depth < 1) depth = 1;
+    if (depth > maxDepth) depth = maxDepth;
+    writer->depth = depth;
+    writer->done = done;
+    writer->context = context;
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        free(writer);
+        return NULL;
+    }
+    writer->hasRing = !(flags & TP_WRITER_PWRITE) && uringSetup(&writer->ring, depth) == 0;
+    writer->useUring = writer->hasRing;
+    writer->stats.backend = writer->useUring ? "io_uring" : "pwrite";
+    return writer;
+}
+
+int asyncwriter_submit(asyncWriter_t* writer, const void* data, size_t length, void* tag) {
+    int index = 0;
+
+    if (writer->useUring) reapCompletions(writer);
+    if (!writer->useUring) {
+        // reapCompletions may have just switched over, so drain whatever the ring still holds first
+        drainWrites(writer);
+        double start = now();
+        int error = pwriteFully(writer->fd, data, length, writer->offset) < 0 ? errno : 0;
+        if (error && !writer->error) writer->error = error;
+        double elapsed = now() - start;
+        writer->stats.busySeconds += elapsed;
+        writer->stats.stalledSeconds += elapsed;
+        writer->stats.writes++;
+        writer->stats.bytes += length;
+        writer->offset += length;
+        if (writer->done) writer->done(writer->context, tag, error);
+        return writer->error ? (errno = writer->error, -1) : 0;
+    }
+
+    while (writer->inFlight == writer->depth) {
+        if (waitForCompletion(writer) < 0) {
+            // nothing went out, but the buffer still goes back
+            if (writer->done) writer->done(writer->context, tag, writer->error);
+            errno = writer->error;
+            return -1;
+        }
+    }
+    while (writer->writes[index].inFlight) index++;
+    writer->writes[index] = (pendingWrite_t){.data = data, .length = length, .offset = writer->offset, .tag = tag, .inFlight = 1};
+    if (writer->inFlight++ == 0) writer->busySince = now();
+    writer->offset += length;
+    writer->stats.writes++;
+    writer->stats.bytes += length;
+    if (uringWrite(writer, index) < 0) {
+        finishWrite(writer, index, errno);
+        errno = writer->error;
+        return -1;
+    }
+    return writer->error ? (errno = writer->error, -1) : 0;
+}
+
+int asyncwriter_poll(asyncWriter_t* writer) {
+    if (writer->inFlight) reapCompletions(writer);
+    return writer->inFlight;
+}
+
+int asyncwriter_close(asyncWriter_t* writer, asyncWriterStats_t* stats) {
+    int error;
+    drainWrites(writer);
+    if (writer->hasRing) uringTeardown(&writer->ring);
+    if (close(writer->fd) < 0 && !writer->error) writer->error = errno;
+    writer->stats.overlap = writer->stats.busySeconds > 0 ? 1 - writer->stats.stalledSeconds / writer->stats.busySeconds : 0;
+    if (writer->stats.overlap < 0) writer->stats.overlap = 0;
+    if (stats) *stats = writer->stats;
+    error = writer->error;
+    free(writer);
+    errno = error;
+    return error ? -1 : 0;
+}
@@ -0,0 +1,929 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <charconv>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "toothpaste.h"
+#include "toothpaste.hpp"
+
+/*
+ * Benchmarks for the toothpaste engine against libc and the C++ standard library.
+ * Build: cc -O2 -c toothpaste.c fixed.c ipv4.c iso8601.c radix.c engines.c adaptive.c tp_printf.c logring.c strpool.c json.c \
+ *            varint.c columnar.c numa.c
+ *        c++ -O2 -std=c++17 bench.cpp toothpaste.o fixed.o ipv4.o iso8601.o radix.o engines.o adaptive.o tp_printf.o logring.o strpool.o \
+ *            json.o varint.o columnar.o numa.o -lm -pthread -o bench
+ * Usage: bench [mode], where mode is one of the names in `modes` below (default: all of them).
+ *
+ * Every run also checks the candidates against snprintf and reports mismatches, since a fast wrong answer
+ * isn't worth timing.
+ */
+
+static const int iterations = 1 << 20;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// keeps the compiler from discarding conversions whose output is never read
+static volatile char sink;
+
+/* ---- dtoa: fixed-precision doubles ---- */
+
+typedef int (*dtoaFunction_t)(double, int, char*);
+
+static int dtoaToothpaste(double value, int precision, char* out) {
+    return dtoa_fixed(value, precision, out);
+}
+
+static int dtoaSnprintf(double value, int precision, char* out) {
+    return snprintf(out, TP_DTOA_FIXED_BUFSIZE, "%.*f", precision, value);
+}
+
+static int dtoaToChars(double value, int precision, char* out) {
+    std::to_chars_result result = std::to_chars(out, out + TP_DTOA_FIXED_BUFSIZE - 1, value, std::chars_format::fixed, precision);
+    *result.ptr = '\0';
+    return result.ptr - out;
+}
+
+static const struct {
+    const char* name;
+    dtoaFunction_t convert;
+} dtoaCandidates[] = {
+    {"toothpaste", dtoaToothpaste},
+    {"snprintf", dtoaSnprintf},
+    {"to_chars", dtoaToChars},
+};
+
+static void benchDtoa() {
+    std::mt19937_64 rng(42);
+    std::vector<double> values(iterations);
+    // metrics-like magnitudes: mostly small, some up to a few billion, a few negative; every eighth value is a
+    // short binary fraction like 2.5 or 0.375, which lands exactly on a rounding tie at some precision
+    for (double& value : values) {
+        if (rng() % 8) value = std::ldexp((double)(rng() >> 11) / (1ull << 53), (int)(rng() % 32));
+        else value = std::ldexp((double)(rng() % 1000000), -(int)(rng() % 12));
+        value *= (rng() & 15) ? 1 : -1;
+    }
+
+    // 12 and above scale the fraction past 2^53, where rounding has to be exact to match
+    for (int precision : {0, 3, 6, 12, 15, 17, 19}) {
+        for (const auto& candidate : dtoaCandidates) {
+            char buffer[TP_DTOA_FIXED_BUFSIZE], reference[TP_DTOA_FIXED_BUFSIZE];
+            long mismatches = 0;
+            for (double value : values) {
+                candidate.convert(value, precision, buffer);
+                dtoaSnprintf(value, precision, reference);
+                if (strcmp(buffer, reference)) mismatches++;
+            }
+
+            double start = now();
+            for (double value : values) {
+                candidate.convert(value, precision, buffer);
+                sink = buffer[0];
+            }
+            double elapsed = now() - start;
+            printf("dtoa  %-12s precision %d: %7.2f ns/op, %ld mismatches\n",
+                   candidate.name, precision, elapsed * 1e9 / iterations, mismatches);
+        }
+    }
+}
+
+/* ---- ipv4: dotted quads ---- */
+
+static int ipv4Snprintf(uint32_t address, char* out) {
+    return snprintf(out, 16, "%u.%u.%u.%u", address >> 24, (address >> 16) & 0xff, (address >> 8) & 0xff, address & 0xff);
+}
+
+static const struct {
+    const char* name;
+    int (*convert)(uint32_t, char*);
+} ipv4Candidates[] = {
+    {"toothpaste", format_ipv4},
+    {"snprintf", ipv4Snprintf},
+};
+
+static void benchIpv4() {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> addresses(iterations);
+    for (uint32_t& address : addresses) address = rng();
+
+    for (const auto& candidate : ipv4Candidates) {
+        char buffer[16], reference[16];
+        long mismatches = 0;
+        for (uint32_t address : addresses) {
+            candidate.convert(address, buffer);
+            ipv4Snprintf(address, reference);
+            if (strcmp(buffer, reference)) mismatches++;
+        }
+
+        double start = now();
+        for (uint32_t address : addresses) {
+            candidate.convert(address, buffer);
+            sink = buffer[0];
+        }
+        double elapsed = now() - start;
+        printf("ipv4  %-12s: %7.2f ns/op, %ld mismatches\n", candidate.name, elapsed * 1e9 / iterations, mismatches);
+    }
+}
+
+/* ---- iso8601: UTC timestamps, plain and with the cached prefix, against gmtime_r + strftime ---- */
+
+static int iso8601Strftime(int64_t epochNanos, char* out, int fracDigits) {
+    int64_t seconds = epochNanos / 1000000000, nanos = epochNanos % 1000000000;
+    if (nanos < 0) {
+        nanos += 1000000000;
+        seconds--;
+    }
+    time_t clock = (time_t)seconds;
+    struct tm civil;
+    gmtime_r(&clock, &civil);
+    int length = (int)strftime(out, 32, "%Y-%m-%dT%H:%M:%S", &civil);
+    if (fracDigits > 0) {
+        int64_t truncated = nanos;
+        for (int d = fracDigits; d < 9; d++) truncated /= 10;
+        length += snprintf(out + length, 32 - length, ".%0*lld", fracDigits, (long long)truncated);
+    }
+    return length + snprintf(out + length, 32 - length, "Z");
+}
+
+static void benchIso8601() {
+    std::mt19937_64 rng(42);
+    std::vector<int64_t> scattered(iterations), ascending(iterations);
+    int64_t clock = 1700000000000000000ll;
+    for (int i = 0; i < iterations; i++) {
+        scattered[i] = (int64_t)rng(); // the whole int64_t range, 1677 to 2262
+        clock += rng() % 2000000;      // about a thousand stamps a second, as a log would see them
+        ascending[i] = clock;
+    }
+    scattered[0] = INT64_MIN;
+    scattered[1] = INT64_MAX;
+    scattered[2] = -1;
+    scattered[3] = 0;
+
+    for (int fracDigits : {0, 3, 9}) {
+        for (const char* name : {"toothpaste", "cached", "strftime"}) {
+            const std::vector<int64_t>& stamps = name[0] == 'c' ? ascending : scattered;
+            char buffer[32], reference[32];
+            long mismatches = 0;
+            iso8601Cache_t cache = {};
+            auto convert = [&](int64_t stamp) {
+                if (name[0] == 't') format_iso8601(stamp, buffer, fracDigits);
+                else if (name[0] == 'c') format_iso8601_cached(&cache, stamp, buffer, fracDigits);
+                else iso8601Strftime(stamp, buffer, fracDigits);
+            };
+            for (int64_t stamp : stamps) {
+                convert(stamp);
+                iso8601Strftime(stamp, reference, fracDigits);
+                if (strcmp(buffer, reference)) mismatches++;
+            }
+
+            cache = {};
+            double start = now();
+            for (int64_t stamp : stamps) {
+                convert(stamp);
+                sink = buffer[0];
+            }
+            double elapsed = now() - start;
+            printf("iso8601 %-10s %d digits: %7.2f ns/op, %ld mismatches\n", name, fracDigits, elapsed * 1e9 / iterations, mismatches);
+        }
+    }
+}
+
+/* ---- itoa: 32-bit integer engines over several input distributions ---- */
+
+static int itoaToothpaste(uint32_t value, char* out) {
+    return fillBuffer(uitodec(value), out);
+}
+
+static int itoaConstantTime(uint32_t value, char* out) {
+    return fillBuffer_ct(uitodec_ct(value), out);
+}
+
+static int itoaDivision(uint32_t value, char* out) {
+    char reversed[10];
+    int length = 0;
+    do {
+        reversed[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < length; i++) out[i] = reversed[length - 1 - i];
+    out[length] = '\0';
+    return length;
+}
+
+static int itoaSnprintf(uint32_t value, char* out) {
+    return snprintf(out, 11, "%u", value);
+}
+
+static int itoaToChars(uint32_t value, char* out) {
+    std::to_chars_result result = std::to_chars(out, out + 10, value);
+    *result.ptr = '\0';
+    return result.ptr - out;
+}
+
+static int itoaToothpasteToChars(uint32_t value, char* out) {
+    std::to_chars_result result = toothpaste::to_chars(out, out + 10, value);
+    *result.ptr = '\0';
+    return result.ptr - out;
+}
+
+static const struct {
+    const char* name;
+    int (*convert)(uint32_t, char*);
+} engines[] = {
+    {"toothpaste", itoaToothpaste},
+    {"radix10", uitoa_radix10},
+    {"consttime", itoaConstantTime},
+    {"setbits", uitoa_setbits},
+    {"byterom", uitoa_byterom},
+    {"pairs", uitoa_pairs},
+    {"adaptive", uitoa_adaptive},
+    {"division", itoaDivision},
+    {"snprintf", itoaSnprintf},
+    {"to_chars", itoaToChars},
+    {"tp::to_chars", itoaToothpasteToChars},
+};
+
+/*
+ * Input distributions. `uniform` is dominated by 10-digit values with the top bits set, which is the
+ * worst case for the per-bit loop; `bitlength` picks the bit length first, so every length is equally common.
+ */
+static const struct {
+    const char* name;
+    uint32_t (*draw)(std::mt19937&);
+} distributions[] = {
+    {"uniform", [](std::mt19937& rng) { return (uint32_t)rng(); }},
+    {"small", [](std::mt19937& rng) { return (uint32_t)(rng() % 1000); }},
+    {"bitlength", [](std::mt19937& rng) { return (uint32_t)(rng() >> (rng() % 32)); }},
+};
+
+static std::vector<uint32_t> drawInputs(uint32_t (*draw)(std::mt19937&), int count) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> values(count);
+    for (uint32_t& value : values) value = draw(rng);
+    return values;
+}
+
+static long countMismatches(int (*convert)(uint32_t, char*), const std::vector<uint32_t>& values) {
+    char buffer[11], reference[11];
+    long mismatches = 0;
+    for (uint32_t value : values) {
+        convert(value, buffer);
+        itoaSnprintf(value, reference);
+        if (strcmp(buffer, reference)) mismatches++;
+    }
+    return mismatches;
+}
+
+static void benchItoa() {
+    for (const auto& distribution : distributions) {
+        std::vector<uint32_t> values = drawInputs(distribution.draw, iterations);
+        for (const auto& engine : engines) {
+            char buffer[11];
+            long mismatches = countMismatches(engine.convert, values);
+            double start = now();
+            for (uint32_t value : values) {
+                engine.convert(value, buffer);
+                sink = buffer[0];
+            }
+            double elapsed = now() - start;
+            printf("itoa  %-10s %-12s: %7.2f ns/op, %ld mismatches\n",
+                   distribution.name, engine.name, elapsed * 1e9 / iterations, mismatches);
+        }
+    }
+}
+
+/* ---- perf: hardware counters per conversion ---- */
+
+/*
+ * Each counter is opened on its own rather than as a group, so a machine (or VM, or container) that lacks
+ * one of them still reports the rest. Counters that can't be opened print as "n/a"; when none can, for
+ * instance with kernel.perf_event_paranoid above 2, the mode says so and falls back to timing only.
+ * Counts cover user space only and are divided by the number of conversions.
+ */
+
+static const struct {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+} perfEvents[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"L1d-misses", PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+static const int perfEventCount = sizeof(perfEvents) / sizeof(perfEvents[0]);
+
+static int openPerfEvent(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void benchPerf() {
+    int fds[perfEventCount];
+    int opened = 0;
+    for (int e = 0; e < perfEventCount; e++) {
+        fds[e] = openPerfEvent(perfEvents[e].type, perfEvents[e].config);
+        if (fds[e] >= 0) opened++;
+    }
+    if (!opened) printf("perf  no hardware counters available (perf_event_open: %s), timing only\n", strerror(errno));
+
+    for (const auto& distribution : distributions) {
+        std::vector<uint32_t> values = drawInputs(distribution.draw, iterations);
+        for (const auto& engine : engines) {
+            char buffer[11];
+            uint64_t counts[perfEventCount];
+
+            for (uint32_t value : values) engine.convert(value, buffer); // warm up tables and branch predictors
+            for (int e = 0; e < perfEventCount; e++) {
+                if (fds[e] < 0) continue;
+                ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+            double start = now();
+            for (uint32_t value : values) {
+                engine.convert(value, buffer);
+                sink = buffer[0];
+            }
+            double elapsed = now() - start;
+            for (int e = 0; e < perfEventCount; e++) {
+                if (fds[e] < 0) continue;
+                ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fds[e], &counts[e], sizeof(counts[e])) != sizeof(counts[e])) counts[e] = 0;
+            }
+
+            printf("perf  %-10s %-12s: %7.2f ns/op", distribution.name, engine.name, elapsed * 1e9 / iterations);
+            for (int e = 0; e < perfEventCount; e++) {
+                if (fds[e] < 0) printf(", %s n/a", perfEvents[e].name);
+                else printf(", %s %.2f", perfEvents[e].name, (double)counts[e] / iterations);
+            }
+            printf("\n");
+        }
+    }
+    for (int e = 0; e < perfEventCount; e++) {
+        if (fds[e] >= 0) close(fds[e]);
+    }
+}
+
+/* ---- latency: per-call timing and tail percentiles ---- */
+
+/*
+ * Each call is bracketed by serialized timestamp reads (lfence on both sides of rdtsc, so the conversion can't
+ * be reordered out of the window). Other architectures fall back to CLOCK_MONOTONIC in nanoseconds.
+ * The cost of an empty window is measured first and subtracted.
+ *
+ * Samples go into an HDR-style log-linear histogram: one group per power of two, split into 32 linear
+ * sub-buckets, so every recorded value is within about 3% of the truth at any magnitude.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t serializedTicks() {
+    _mm_lfence();
+    uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+}
+static const char* tickUnit = "cycles";
+#else
+static inline uint64_t serializedTicks() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+static const char* tickUnit = "ns";
+#endif
+
+static const int subBucketBits = 5;
+
+struct latencyHistogram_t {
+    uint64_t counts[64 << subBucketBits] = {};
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    static int bucketOf(uint64_t value) {
+        if (value < (1u << subBucketBits)) return (int)value;
+        int exponent = 63 - __builtin_clzll(value) - subBucketBits + 1;
+        return (exponent << subBucketBits) + (int)((value >> (exponent - 1)) & ((1u << subBucketBits) - 1));
+    }
+
+    static uint64_t lowestOf(int bucket) {
+        int exponent = bucket >> subBucketBits;
+        uint64_t subBucket = bucket & ((1u << subBucketBits) - 1);
+        if (!exponent) return subBucket;
+        return (subBucket | (1u << subBucketBits)) << (exponent - 1);
+    }
+
+    void record(uint64_t value) {
+        counts[bucketOf(value)]++;
+        total++;
+        if (value > max) max = value;
+    }
+
+    uint64_t percentile(double fraction) const {
+        uint64_t rank = (uint64_t)std::ceil(fraction * total);
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < (64 << subBucketBits); bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank && seen) return lowestOf(bucket);
+        }
+        return max;
+    }
+};
+
+static void benchLatency() {
+    uint64_t overhead = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = serializedTicks();
+        uint64_t elapsed = serializedTicks() - start;
+        if (elapsed < overhead) overhead = elapsed;
+    }
+    printf("latency  timer overhead %llu %s subtracted from every sample\n", (unsigned long long)overhead, tickUnit);
+
+    for (const auto& distribution : distributions) {
+        std::vector<uint32_t> values = drawInputs(distribution.draw, iterations);
+        for (const auto& engine : engines) {
+            static latencyHistogram_t histogram;
+            char buffer[11];
+            histogram = latencyHistogram_t();
+            for (uint32_t value : values) engine.convert(value, buffer);
+            for (uint32_t value : values) {
+                uint64_t start = serializedTicks();
+                engine.convert(value, buffer);
+                uint64_t elapsed = serializedTicks() - start;
+                sink = buffer[0];
+                histogram.record(elapsed > overhead ? elapsed - overhead : 0);
+            }
+            printf("latency  %-10s %-12s: p50 %6llu  p99 %6llu  p999 %6llu  max %8llu %s\n",
+                   distribution.name, engine.name,
+                   (unsigned long long)histogram.percentile(0.5), (unsigned long long)histogram.percentile(0.99),
+                   (unsigned long long)histogram.percentile(0.999), (unsigned long long)histogram.max, tickUnit);
+        }
+    }
+}
+
+/* ---- cold: conversions with the tables evicted ---- */
+
+/*
+ * A tight loop keeps decimalROM, quotients and remainders in L1, which flatters the table-driven engines.
+ * Two scenarios take that away:
+ *   - flush: clflush every line of the engine's own tables before each call (x86 only), as reported by
+ *     tp_engine_tables and friends. This isolates what the table misses cost. The standard library's
+ *     tables can't be reached, so snprintf and to_chars run warm and their rows say so.
+ *   - thrash: read through a buffer larger than the last-level cache before each batch, which evicts
+ *     everyone's data alike, closer to a formatter called between chunks of request handling.
+ * Batches of 1 and 16 conversions show how quickly each engine recovers once its tables are back.
+ * Only the conversions are timed, never the eviction.
+ */
+
+static const int coldRounds = 500;
+static const size_t thrashBytes = 32 << 20;
+
+static void flushLines(const void* start, size_t bytes) {
+#if defined(__x86_64__) || defined(__i386__)
+    for (size_t offset = 0; offset < bytes; offset += 64) _mm_clflush((const char*)start + offset);
+    _mm_mfence();
+#else
+    (void)start;
+    (void)bytes;
+#endif
+}
+
+// every table `engine` reads; 0 for an engine without any, -1 for one whose tables we can't reach
+static int engineTables(const char* engine, engineTable_t tables[TP_MAX_ENGINE_TABLES]) {
+    static const struct {
+        const char* name;
+        int engine;
+    } tableDriven[] = {
+        {"toothpaste", TP_ENGINE_TOOTHPASTE}, {"tp::to_chars", TP_ENGINE_TOOTHPASTE}, {"setbits", TP_ENGINE_SETBITS},
+        {"byterom", TP_ENGINE_BYTEROM},       {"pairs", TP_ENGINE_PAIRS},
+    };
+    for (const auto& entry : tableDriven) {
+        if (!strcmp(engine, entry.name)) return tp_engine_tables(entry.engine, tables);
+    }
+    if (!strcmp(engine, "radix10")) return uitoa_radix_tables(10, tables);
+    if (!strcmp(engine, "adaptive")) return tp_adaptive_tables(tables);
+    if (!strcmp(engine, "consttime")) {
+        // the constant-time squeeze divides by multiplying instead of reading the carry tables
+        tables[0] = engineTable_t{decimalROM, sizeof(decimalROM)};
+        return 1;
+    }
+    if (!strcmp(engine, "division")) return 0;
+    return -1;
+}
+
+static void flushTables(const engineTable_t* tables, int count) {
+    for (int t = 0; t < count; t++) flushLines(tables[t].start, tables[t].bytes);
+}
+
+static void thrashCaches(std::vector<uint8_t>& buffer) {
+    uint8_t sum = 0;
+    for (size_t offset = 0; offset < buffer.size(); offset += 64) sum += buffer[offset]++;
+    sink = sum;
+}
+
+static void benchCold() {
+    std::vector<uint8_t> thrashBuffer(thrashBytes, 1);
+    std::vector<uint32_t> values = drawInputs(distributions[0].draw, coldRounds * 16);
+
+    for (const auto& engine : engines) {
+#if defined(__x86_64__) || defined(__i386__)
+        {
+            char buffer[11];
+            latencyHistogram_t* histogram = new latencyHistogram_t();
+            uint64_t total = 0;
+            engineTable_t tables[TP_MAX_ENGINE_TABLES];
+            int tableCount = engineTables(engine.name, tables);
+            for (int round = 0; round < coldRounds; round++) {
+                flushTables(tables, tableCount);
+                uint64_t start = serializedTicks();
+                engine.convert(values[round], buffer);
+                uint64_t elapsed = serializedTicks() - start;
+                sink = buffer[0];
+                histogram->record(elapsed);
+                total += elapsed;
+            }
+            printf("cold  flush     batch  1 %-12s: mean %7.1f  p50 %6llu %s/conversion%s\n", engine.name,
+                   (double)total / coldRounds, (unsigned long long)histogram->percentile(0.5), tickUnit,
+                   tableCount < 0 ? ", tables not flushed" : "");
+            delete histogram;
+        }
+#endif
+        for (int batch : {1, 16}) {
+            char buffer[11];
+            latencyHistogram_t* histogram = new latencyHistogram_t();
+            uint64_t total = 0;
+            for (int round = 0; round < coldRounds; round++) {
+                thrashCaches(thrashBuffer);
+                uint64_t start = serializedTicks();
+                for (int i = 0; i < batch; i++) {
+                    engine.convert(values[round * 16 + i], buffer);
+                    sink = buffer[0];
+                }
+                uint64_t elapsed = serializedTicks() - start;
+                histogram->record(elapsed / batch);
+                total += elapsed;
+            }
+            printf("cold  thrash    batch %2d %-12s: mean %7.1f  p50 %6llu %s/conversion\n", batch, engine.name,
+                   (double)total / coldRounds / batch, (unsigned long long)histogram->percentile(0.5), tickUnit);
+            delete histogram;
+        }
+    }
+}
+
+/* ---- printf: a log-line format through tp_snprintf ---- */
+
+static void benchPrintf() {
+    static const char* format = "req=%u status=%d bytes=%llu latency_us=%6u user=%s\n";
+    std::vector<uint32_t> values = drawInputs(distributions[2].draw, iterations);
+    compiledFormat_t* compiled = tp_format_compile(format);
+    char buffer[128], reference[128];
+    long mismatches[2] = {0, 0}; // tp_snprintf, compiled
+
+    // every third line into a buffer too short for it, so truncation and the returned length are checked as well
+    for (int i = 0; i < iterations; i++) {
+        uint32_t value = values[i];
+        size_t size = i % 3 ? sizeof(buffer) : 1 + value % 40;
+        int length = snprintf(reference, size, format, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+        int candidate = tp_snprintf(buffer, size, format, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+        if (candidate != length || strcmp(buffer, reference)) mismatches[0]++;
+        candidate = tp_snprintf_compiled(buffer, size, compiled, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+        if (candidate != length || strcmp(buffer, reference)) mismatches[1]++;
+    }
+
+    for (const char* name : {"snprintf", "tp_snprintf", "compiled"}) {
+        double start = now();
+        for (int i = 0; i < iterations; i++) {
+            uint32_t value = values[i];
+            if (name[0] == 's') {
+                snprintf(buffer, sizeof(buffer), format, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+            } else if (name[0] == 't') {
+                tp_snprintf(buffer, sizeof(buffer), format, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+            } else {
+                tp_snprintf_compiled(buffer, sizeof(buffer), compiled, value, (int)(value % 600), (unsigned long long)value * 977, value % 100000, "alice");
+            }
+            sink = buffer[0];
+        }
+        double elapsed = now() - start;
+        if (name[0] == 's') printf("printf %-12s: %7.2f ns/line, reference\n", name, elapsed * 1e9 / iterations);
+        else printf("printf %-12s: %7.2f ns/line, %ld mismatches\n", name, elapsed * 1e9 / iterations, mismatches[name[0] == 'c']);
+    }
+    tp_format_free(compiled);
+}
+
+/* ---- logring: deferred formatting from several producers, checked for order and for the text itself ---- */
+
+// each producer's values encode its own running count, so the sink can tell whose line it is and whether it's next
+enum { logProducers = 3 };
+
+struct logCheck {
+    uint64_t expected[logProducers];
+    long lines;
+    long mismatches;
+    long outOfOrder;
+};
+
+static void checkLogBatch(const char* text, size_t length, void* context) {
+    logCheck* check = (logCheck*)context;
+    const char* end = text + length;
+    while (text < end) {
+        const char* newline = (const char*)memchr(text, '\n', end - text);
+        char line[24], reference[24];
+        size_t lineLength = newline ? newline - text : end - text;
+        if (lineLength >= sizeof(line)) lineLength = sizeof(line) - 1;
+        memcpy(line, text, lineLength);
+        line[lineLength] = '\0';
+        text += lineLength + 1;
+        check->lines++;
+
+        int producer;
+        uint64_t count;
+        if (line[0] == '-') {
+            // producer 1: -(count + 1) as TP_LOG_I64
+            int64_t value = strtoll(line, NULL, 10);
+            snprintf(reference, sizeof(reference), "%lld", (long long)value);
+            producer = 1;
+            count = (uint64_t)-(value + 1);
+        } else {
+            uint64_t value = strtoull(line, NULL, 10);
+            snprintf(reference, sizeof(reference), "%llu", (unsigned long long)value);
+            // producer 0: UINT64_MAX - count as TP_LOG_U64; producer 2: count as TP_LOG_U32
+            producer = value > UINT32_MAX ? 0 : 2;
+            count = producer ? value : UINT64_MAX - value;
+        }
+        if (strcmp(line, reference)) check->mismatches++;
+        if (count != check->expected[producer]++) {
+            check->outOfOrder++;
+            check->expected[producer] = count + 1;
+        }
+    }
+}
+
+static void benchLogring() {
+    logCheck check = {};
+    logRing_t* ring = logring_create(4096, checkLogBatch, &check);
+    std::vector<std::thread> producers;
+    long retries[logProducers] = {};
+
+    if (!ring) {
+        printf("logring: couldn't create the ring\n");
+        return;
+    }
+    double start = now();
+    for (int producer = 0; producer < logProducers; producer++) {
+        producers.emplace_back([ring, producer, &retries] {
+            for (uint64_t count = 0; count < (uint64_t)iterations; count++) {
+                uint64_t value = producer == 0 ? UINT64_MAX - count : producer == 1 ? (uint64_t)-(int64_t)(count + 1) : count;
+                int tag = producer == 0 ? TP_LOG_U64 : producer == 1 ? TP_LOG_I64 : TP_LOG_U32;
+                // a full ring just means the consumer is behind; a real producer would drop, this one waits
+                while (logring_push(ring, value, tag) < 0) {
+                    retries[producer]++;
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& producer : producers) producer.join();
+    logring_destroy(ring);
+    double elapsed = now() - start;
+
+    bool complete = check.lines == (long)logProducers * iterations;
+    for (int producer = 0; producer < logProducers; producer++) complete &= check.expected[producer] == (uint64_t)iterations;
+    printf("logring %d producers: %7.2f ns/value, %ld lines, %ld mismatches, %ld out of order, %s, %ld full-ring retries\n",
+           logProducers, elapsed * 1e9 / check.lines, check.lines, check.mismatches, check.outOfOrder,
+           complete ? "complete" : "INCOMPLETE", retries[0] + retries[1] + retries[2]);
+}
+
+/* ---- strpool: pooled views, plain and interned, checked after the whole batch is in ---- */
+
+static void benchStrpool() {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> values(iterations);
+    std::vector<stringView_t> views(iterations);
+    // a quarter of the values repeat an earlier one, so interning has something to find
+    for (int i = 0; i < iterations; i++) values[i] = i && rng() % 4 == 0 ? values[rng() % i] : rng() >> (rng() % 64);
+
+    for (int flags : {0, TP_POOL_INTERN}) {
+        stringPool_t* pool = strpool_create(0, flags);
+        size_t firstRound = 0;
+        if (!pool) {
+            printf("strpool: couldn't create the pool\n");
+            return;
+        }
+        for (int round = 0; round < 3; round++) {
+            long mismatches = 0, unshared = 0;
+            strpool_reset(pool);
+            double start = now();
+            for (int i = 0; i < iterations; i++) {
+                views[i] = values[i] <= UINT32_MAX ? strpool_u32(pool, (uint32_t)values[i]) : strpool_u64(pool, values[i]);
+            }
+            double elapsed = now() - start;
+
+            // every view must still hold its text once the pool has grown past it
+            for (int i = 0; i < iterations; i++) {
+                char reference[21];
+                int length = snprintf(reference, sizeof(reference), "%llu", (unsigned long long)values[i]);
+                if (!views[i].ptr || views[i].len != (uint32_t)length || strcmp(views[i].ptr, reference)) mismatches++;
+            }
+            // interned, converting any of them again must hand back the same view
+            for (int i = 0; flags && i < iterations; i++) {
+                stringView_t again = values[i] <= UINT32_MAX ? strpool_u32(pool, (uint32_t)values[i]) : strpool_u64(pool, values[i]);
+                unshared += again.ptr != views[i].ptr;
+            }
+            if (round == 0) firstRound = strpool_bytes_used(pool);
+            printf("strpool %-8s round %d: %7.2f ns/value, %ld mismatches, %ld uninterned repeats, %zu bytes%s\n",
+                   flags ? "interned" : "plain", round, elapsed * 1e9 / iterations, mismatches, unshared,
+                   strpool_bytes_used(pool), round && strpool_bytes_used(pool) != firstRound ? " (CHANGED)" : "");
+        }
+        strpool_destroy(pool);
+    }
+}
+
+/* ---- json: whole integer arrays to JSON text against an snprintf loop ---- */
+
+template <typename T>
+static size_t jsonSnprintf(const std::vector<T>& values, char* out, size_t capacity) {
+    size_t length = snprintf(out, capacity, "[");
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i) out[length++] = ',';
+        if (std::is_signed<T>::value) length += snprintf(out + length, capacity - length, "%lld", (long long)values[i]);
+        else length += snprintf(out + length, capacity - length, "%llu", (unsigned long long)values[i]);
+    }
+    return length + snprintf(out + length, capacity - length, "]");
+}
+
+template <typename T>
+static void checkJson(const char* name, std::vector<T> values, int64_t (*format)(const T*, size_t, char*, size_t), size_t maxSize) {
+    std::vector<char> text(maxSize), reference(maxSize);
+    double start = now();
+    int64_t length = format(values.data(), values.size(), text.data(), text.size());
+    double elapsed = now() - start;
+    start = now();
+    size_t referenceLength = jsonSnprintf(values, reference.data(), reference.size());
+    double referenceElapsed = now() - start;
+    bool matches = length == (int64_t)referenceLength && !strcmp(text.data(), reference.data());
+
+    // the edges: an empty array, and a buffer one byte short of the worst case, which must be refused untouched
+    char empty[4];
+    matches &= format(values.data(), 0, empty, sizeof(empty)) == 2 && !strcmp(empty, "[]");
+    text[0] = '?';
+    matches &= format(values.data(), values.size(), text.data(), maxSize - 1) == -1 && text[0] == '?';
+
+    printf("json  %-4s: %7.2f ns/value, snprintf %7.2f ns/value, %s\n", name, elapsed * 1e9 / values.size(),
+           referenceElapsed * 1e9 / values.size(), matches ? "matches" : "MISMATCH");
+}
+
+static void benchJson() {
+    std::mt19937_64 rng(42);
+    std::vector<uint32_t> u32(iterations);
+    std::vector<uint64_t> u64(iterations);
+    std::vector<int64_t> i64(iterations);
+    for (int i = 0; i < iterations; i++) {
+        uint64_t draw = rng() >> (rng() % 64); // every length, not just the long ones
+        u32[i] = (uint32_t)draw;
+        u64[i] = draw;
+        i64[i] = rng() % 2 ? (int64_t)draw : -(int64_t)(draw >> 1);
+    }
+    u32[0] = 0, u32[1] = UINT32_MAX;
+    u64[0] = 0, u64[1] = UINT64_MAX;
+    i64[0] = 0, i64[1] = INT64_MIN, i64[2] = INT64_MAX, i64[3] = -1;
+
+    checkJson("u32", u32, tp_json_array_u32, TP_JSON_ARRAY_U32_MAX(iterations));
+    checkJson("u64", u64, tp_json_array_u64, TP_JSON_ARRAY_U64_MAX(iterations));
+    checkJson("i64", i64, tp_json_array_i64, TP_JSON_ARRAY_I64_MAX(iterations));
+}
+
+/* ---- varint: protobuf-style varints to lines of text, decoded first vs. fused ---- */
+
+static size_t encodeVarint(uint64_t value, uint8_t* out) {
+    size_t length = 0;
+    do {
+        out[length] = (value & 0x7f) | (value > 0x7f ? 0x80 : 0);
+        value >>= 7;
+        length++;
+    } while (value);
+    return length;
+}
+
+static void benchVarint() {
+    std::vector<uint32_t> draws = drawInputs(distributions[2].draw, iterations);
+    std::vector<uint8_t> encoded(iterations * 10);
+    std::vector<char> text(iterations * 21), reference(iterations * 21);
+    size_t encodedSize = 0, referenceSize = 0, consumed;
+
+    for (int i = 0; i < iterations; i++) {
+        uint64_t value = (uint64_t)draws[i] << (draws[i] % 33);
+        encodedSize += encodeVarint(value, encoded.data() + encodedSize);
+        referenceSize += snprintf(reference.data() + referenceSize, 22, "%llu\n", (unsigned long long)value);
+    }
+
+    for (const char* name : {"decode+uitoa64", "fused"}) {
+        double start = now();
+        int64_t written = 0;
+        if (name[0] == 'd') {
+            size_t inPtr = 0;
+            while (inPtr < encodedSize) {
+                uint64_t value = 0;
+                int shift = 0;
+                uint8_t byte;
+                do {
+                    byte = encoded[inPtr++];
+                    value |= (uint64_t)(byte & 0x7f) << shift;
+                    shift += 7;
+                } while (byte & 0x80);
+                written += fillBuffer64(uitodec64(value), text.data() + written);
+                text[written++] = '\n';
+            }
+        } else {
+            written = tp_varint_format_batch(encoded.data(), encodedSize, &consumed, text.data(), text.size(), '\n');
+        }
+        double elapsed = now() - start;
+        bool matches = (size_t)written == referenceSize && !memcmp(text.data(), reference.data(), referenceSize);
+        printf("varint %-15s: %7.2f ns/value, %s\n", name, elapsed * 1e9 / iterations, matches ? "matches" : "MISMATCH");
+    }
+}
+
+/* ---- numa: column fill with node-local tables and output vs. deliberately remote ones ---- */
+
+static void benchNuma() {
+    const size_t rows = 1 << 22;
+    std::vector<uint32_t> values = drawInputs(distributions[0].draw, rows);
+    std::vector<int32_t> offsets(rows + 1);
+    std::vector<char> shared(rows * 10);
+    int nodes = tp_numa_nodes();
+    values[0] = 0, values[1] = UINT32_MAX;
+
+    // measuring is timed too, since the numa calls do it themselves
+    double start = now();
+    size_t size = tp_column_u32_measure(values.data(), rows, offsets.data());
+    tp_column_u32_fill(values.data(), rows, offsets.data(), shared.data(), 0);
+    double elapsed = now() - start;
+
+    // the numa columns are compared against this one byte for byte, so it has to be right on its own
+    long mismatches = offsets[0] != 0 || (size_t)offsets[rows] != size;
+    for (size_t row = 0; row < rows; row++) {
+        char reference[12];
+        int length = snprintf(reference, sizeof(reference), "%u", values[row]);
+        if (offsets[row+1] - offsets[row] != length || memcmp(shared.data() + offsets[row], reference, length)) mismatches++;
+    }
+    printf("numa  %d node%s\n", nodes, nodes == 1 ? " (remote only misplaces the output)" : "s");
+    printf("numa  %-12s: %7.2f ns/row, %ld mismatches\n", "columnar", elapsed * 1e9 / rows, mismatches);
+
+    for (int flags : {0, TP_NUMA_REMOTE}) {
+        size_t dataSize;
+        start = now();
+        char* data = tp_numa_column_u32(values.data(), rows, offsets.data(), &dataSize, 0, flags);
+        elapsed = now() - start;
+        bool matches = data && dataSize == size && !memcmp(data, shared.data(), size);
+        printf("numa  %-12s: %7.2f ns/row, %s\n", flags ? "remote" : "local", elapsed * 1e9 / rows, matches ? "matches" : "MISMATCH");
+        tp_numa_free(data, dataSize);
+    }
+}
+
+static const struct {
+    const char* name;
+    void (*run)();
+} modes[] = {
+    {"dtoa", benchDtoa},
+    {"ipv4", benchIpv4},
+    {"iso8601", benchIso8601},
+    {"itoa", benchItoa},
+    {"perf", benchPerf},
+    {"latency", benchLatency},
+    {"cold", benchCold},
+    {"printf", benchPrintf},
+    {"logring", benchLogring},
+    {"strpool", benchStrpool},
+    {"json", benchJson},
+    {"varint", benchVarint},
+    {"numa", benchNuma},
+};
+
+int main(int argc, char** argv) {
+    for (const auto& mode : modes) {
+        if (argc < 2 || !strcmp(argv[1], mode.name)) mode.run();
+    }
+}
@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "toothpaste.h"
+
+/*
+ * Integer columns to Arrow-style string columns: one contiguous data buffer plus int32 offsets, where row i is
+ * data[offsets[i], offsets[i+1]) and nothing is terminated.
+ *
+ * Two passes. The first counts the digits of every row (no conversion needed, just comparisons against powers of
+ * ten) and prefix-sums them into the offsets, so the exact data size is known before anything is written.
+ * The second converts every row straight into its final place; the rows are independent, so this pass is split
+ * across threads in contiguous ranges. Rows are copied out of the zero-padded accumulator rather than through
+ * fillBuffer, whose terminator would land on the first byte of the next row and race with the thread writing it.
+ */
+
+static const uint64_t powersOf10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+static int digitCount(uint64_t value) {
+    // setting the low bit never changes the digit count (powers of ten are even) and makes 0 count as 1
+    value |= 1;
+    // the bit length gives log10 to within one: 1233 / 4096 is just above log10(2)
+    int bits = 64 - __builtin_clzll(value);
+    int estimate = (bits * 1233) >> 12;
+    return estimate + 1 - (value < powersOf10[estimate]);
+}
+
+typedef struct {
+    const void* values;
+    int wide;
+    size_t begin;
+    size_t end;
+    const int32_t* offsets;
+    char* data;
+} fillRange_t;
+
+static void fillRows(const fillRange_t* range) {
+    for (size_t row = range->begin; row < range->end; row++) {
+        char* out = range->data + range->offsets[row];
+        int length = range->offsets[row + 1] - range->offsets[row];
+        if (range->wide) {
+            fullDecimal64_t decimal = uitodec64(((const uint64_t*)range->values)[row]);
+            for (int d = 20 - length; d < 20; d++) *out++ = decimal.digits[d] + '0';
+        } else {
+            fullDecimal32_t decimal = uitodec(((const uint32_t*)range->values)[row]);
+            for (int d = 10 - length; d < 10; d++) *out++ = decimal.digits[d] + '0';
+        }
+    }
+}
+
+static void* fillMain(void* argument) {
+    fillRows(argument);
+    return NULL;
+}
+
+static size_t measure(const void* values, int wide, size_t count, int32_t* offsets) {
+    int64_t total = 0;
+    offsets[0] = 0;
+    for (size_t row = 0; row < count; row++) {
+        total += digitCount(wide ? ((const uint64_t*)values)[row] : ((const uint32_t*)values)[row]);
+        if (total > INT32_MAX) return SIZE_MAX;
+        offsets[row + 1] = (int32_t)total;
+    }
+    return (size_t)total;
+}
+
+static void fill(const void* values, int wide, size_t count, const int32_t* offsets, char* data, int threads) {
+    pthread_t workers[64];
+    fillRange_t ranges[64];
+    int started[64] = {0};
+
+    if (threads < 1) threads = 1;
+    if (threads > 64) threads = 64;
+    if ((size_t)threads > count / 4096 + 1) threads = count / 4096 + 1; // not worth a thread below a few thousand rows
+
+    for (int t = 0; t < threads; t++) {
+        ranges[t] = (fillRange_t){values, wide, count * t / threads, count * (t + 1) / threads, offsets, data};
+    }
+    // the calling thread takes the first range, and any range whose thread couldn't be started
+    for (int t = 1; t < threads; t++) started[t] = !pthread_create(&workers[t], NULL, fillMain, &ranges[t]);
+    for (int t = 0; t < threads; t++) {
+        if (!started[t]) fillRows(&ranges[t]);
+    }
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(workers[t], NULL);
+    }
+}
+
+size_t tp_column_u32_measure(const uint32_t* values, size_t count, int32_t* offsets) {
+    return measure(values, 0, count, offsets);
+}
+
+size_t tp_column_u64_measure(const uint64_t* values, size_t count, int32_t* offsets) {
+    return measure(values, 1, count, offsets);
+}
+
+void tp_column_u32_fill(const uint32_t* values, size_t count, const int32_t* offsets, char* data, int threads) {
+    fill(values, 0, count, offsets, data, threads);
+}
+
+void tp_column_u64_fill(const uint64_t* values, size_t count, const int32_t* offsets, char* data, int threads) {
+    fill(values, 1, count, offsets, data, threads);
+}
@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "toothpaste.h"
+#include "toothpaste_core.h"
+
+/*
+ * Alternative 32-bit engines, each strongest on a different kind of input:
+ *   - setbits: visits only the set bits (count trailing zeros, clear lowest), so its cost follows popcount.
+ *   - byterom: one ROM per byte position holding the decimal of every byte value there; always four adds.
+ *   - pairs:   plain division, two digits at a time from a 00-99 table; cheapest for short numbers.
+ * The first two feed the same accumulator, squeeze and fillBuffer as uitodec.
+ */
+
+fullDecimal32_t uitodec_setbits(uint32_t i) {
+    fullDecimal32_t accumulator = {.arith = {0, 0}};
+    while (i) {
+        const fullDecimal32_t* addend = &decimalROM[31 - __builtin_ctz(i)];
+        accumulator.arith.high += addend->arith.high;
+        accumulator.arith.low += addend->arith.low;
+        i &= i - 1;
+    }
+    squeeze32(&accumulator, quotients, remainders);
+    return accumulator;
+}
+
+int uitoa_setbits(uint32_t i, char* a) {
+    return fillBuffer(uitodec_setbits(i), a);
+}
+
+/*
+ * byteROM[b][v] is the decimal of v << (8 * (3 - b)), squeezed so every slot is 0-9. Four of them add up to at
+ * most 36 per slot. 4 x 256 entries are too many to write out like decimalROM, so they're built from it the
+ * first time they're needed.
+ */
+static fullDecimal32_t byteROM[4][256];
+static pthread_once_t byteROMOnce = PTHREAD_ONCE_INIT;
+
+static void buildByteROM(void) {
+    for (int b = 0; b < 4; b++) {
+        for (int v = 0; v < 256; v++) {
+            fullDecimal32_t entry = {.arith = {0, 0}};
+            for (int bit = 0; bit < 8; bit++) {
+                if (v & (0x80 >> bit)) {
+                    entry.arith.high += decimalROM[b * 8 + bit].arith.high;
+                    entry.arith.low += decimalROM[b * 8 + bit].arith.low;
+                }
+            }
+            squeeze32(&entry, quotients, remainders);
+            byteROM[b][v] = entry;
+        }
+    }
+}
+
+fullDecimal32_t uitodec_byterom(uint32_t i) {
+    fullDecimal32_t accumulator = {.arith = {0, 0}};
+    pthread_once(&byteROMOnce, buildByteROM);
+    for (int b = 0; b < 4; b++) {
+        const fullDecimal32_t* addend = &byteROM[b][(i >> (8 * (3 - b))) & 0xff];
+        accumulator.arith.high += addend->arith.high;
+        accumulator.arith.low += addend->arith.low;
+    }
+    squeeze32(&accumulator, quotients, remainders);
+    return accumulator;
+}
+
+int uitoa_byterom(uint32_t i, char* a) {
+    return fillBuffer(uitodec_byterom(i), a);
+}
+
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+int uitoa_pairs(uint32_t i, char* a) {
+    char reversed[10];
+    char* end = reversed + 10;
+    char* bufferPtr = end;
+    int length;
+
+    while (i >= 100) {
+        uint32_t pair = i % 100;
+        i /= 100;
+        bufferPtr -= 2;
+        memcpy(bufferPtr, &digitPairs[pair * 2], 2);
+    }
+    if (i >= 10) {
+        bufferPtr -= 2;
+        memcpy(bufferPtr, &digitPairs[i * 2], 2);
+    } else {
+        *--bufferPtr = '0' + i;
+    }
+    length = end - bufferPtr;
+    memcpy(a, bufferPtr, length);
+    a[length] = '\0';
+    return length;
+}
+
+int tp_engine_tables(int engine, engineTable_t tables[TP_MAX_ENGINE_TABLES]) {
+    switch (engine) {
+    case TP_ENGINE_TOOTHPASTE:
+    case TP_ENGINE_SETBITS:
+        tables[0] = (engineTable_t){decimalROM, sizeof(decimalROM)};
+        tables[1] = (engineTable_t){quotients, sizeof(quotients)};
+        tables[2] = (engineTable_t){remainders, sizeof(remainders)};
+        return 3;
+    case TP_ENGINE_BYTEROM:
+        // built here if it hasn't been yet, so the caller never evicts a table that is about to be written
+        pthread_once(&byteROMOnce, buildByteROM);
+        tables[0] = (engineTable_t){byteROM, sizeof(byteROM)};
+        tables[1] = (engineTable_t){quotients, sizeof(quotients)};
+        tables[2] = (engineTable_t){remainders, sizeof(remainders)};
+        return 3;
+    case TP_ENGINE_PAIRS:
+        tables[0] = (engineTable_t){digitPairs, sizeof(digitPairs)};
+        return 1;
+    }
+    return -1;
+}
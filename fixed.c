@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "toothpaste.h"
+
+/*
+ * Fixed-point formatting for scaled integers (cents, microseconds, ...).
+ *
+ * The engine already hands us every decimal place zero-padded, so the decimal point can be dropped in
+ * while copying digits out instead of splitting the value with a division and formatting two halves.
+ * `point` is the index in `digits` where the fraction starts; it goes negative when the scale is wider
+ * than the accumulator, in which case the missing places are emitted as zeros.
+ */
+
+static int fillFixed(const uint8_t* digits, int width, int scale, int flags, char* out) {
+    int point = width - scale;
+    int fractionStart = point > 0 ? point : 0;
+    int end = width;
+    int decimalPtr = 0;
+    char* bufferPtr = out;
+
+    if (flags & TP_FIXED_TRIM_ZEROS) {
+        while (end > fractionStart && digits[end-1] == 0) end--;
+    }
+
+    if (point <= 0) {
+        *bufferPtr++ = '0';
+    } else {
+        // keep the last integer place even when it is zero, so 0.5 isn't written as .5
+        while (decimalPtr < point - 1 && digits[decimalPtr] == 0) decimalPtr++;
+        while (decimalPtr < point) *bufferPtr++ = digits[decimalPtr++] + '0';
+    }
+
+    if (end > fractionStart) {
+        *bufferPtr++ = '.';
+        for (int i = point; i < 0; i++) *bufferPtr++ = '0';
+        for (decimalPtr = fractionStart; decimalPtr < end; decimalPtr++) *bufferPtr++ = digits[decimalPtr] + '0';
+    }
+    *bufferPtr = '\0';
+    return bufferPtr - out;
+}
+
+int uitoa_fixed(uint32_t value, int scale, int flags, char* out) {
+    if (scale < 0) return -1;
+    fullDecimal32_t decimal = uitodec(value);
+    return fillFixed(decimal.digits, 10, scale, flags, out);
+}
+
+int uitoa_fixed64(uint64_t value, int scale, int flags, char* out) {
+    if (scale < 0) return -1;
+    fullDecimal64_t decimal = uitodec64(value);
+    return fillFixed(decimal.digits, 20, scale, flags, out);
+}
+
+static const uint64_t powersOf10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+// snprintf for the cases the fast path doesn't take; -1, with `out` empty, if the text doesn't fit
+static int dtoaFallback(double value, int precision, char* out) {
+    int length = snprintf(out, TP_DTOA_FIXED_BUFSIZE, "%.*f", precision < 0 ? 6 : precision, value);
+    if (length < 0 || length >= TP_DTOA_FIXED_BUFSIZE) {
+        out[0] = '\0';
+        return -1;
+    }
+    return length;
+}
+
+/*
+ * Rounding is exact, as printf's is. The integer part of a double is exact, and so is the fraction
+ * value - floor(value) = m / 2^e with m < 2^53, so fraction * 10^precision = m * 10^precision / 2^e is computed
+ * in 128 bits (m * 10^19 < 2^117) and rounded half-to-even on the parity of the whole scaled number.
+ * For e beyond 117 the product is below half a unit, which the same comparison rounds down.
+ */
+int dtoa_fixed(double value, int precision, char* out) {
+    char* bufferPtr = out;
+    bool negative = signbit(value);
+    double integral, fractionPart;
+    uint64_t integer, fraction = 0;
+    unsigned __int128 whole;
+
+    if (precision < 0 || precision > 19 || !isfinite(value) || fabs(value) >= 18446744073709551616.0) {
+        return dtoaFallback(value, precision, out);
+    }
+
+    if (negative) {
+        *bufferPtr++ = '-';
+        value = -value;
+    }
+    integral = floor(value);
+    fractionPart = value - integral;
+    integer = (uint64_t)integral;
+
+    if (fractionPart != 0) {
+        int exponent;
+        uint64_t mantissa = (uint64_t)ldexp(frexp(fractionPart, &exponent), 53);
+        int shift = 53 - exponent; // fractionPart = mantissa / 2^shift; exponent <= 0 since fractionPart < 1, so shift >= 53
+        unsigned __int128 product = (unsigned __int128)mantissa * powersOf10[precision];
+        unsigned __int128 remainder, half;
+        if (shift < 128) {
+            fraction = (uint64_t)(product >> shift);
+            remainder = product & (((unsigned __int128)1 << shift) - 1);
+            half = (unsigned __int128)1 << (shift - 1);
+        } else {
+            remainder = product;
+            half = (unsigned __int128)1 << 127;
+        }
+        // the whole number's parity: 10^precision is even unless precision is 0, where the fraction rounds to 0 or 1
+        uint64_t odd = precision ? fraction & 1 : integer & 1;
+        if (remainder > half || (remainder == half && odd)) fraction++;
+    }
+
+    // the rounded fraction can come out as 10^precision, carrying into the integer part
+    whole = (unsigned __int128)integer * powersOf10[precision] + fraction;
+    if (whole > UINT64_MAX) return dtoaFallback(negative ? -value : value, precision, out);
+    return (bufferPtr - out) + uitoa_fixed64((uint64_t)whole, precision, 0, bufferPtr);
+}
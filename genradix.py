@@ -0,0 +1,83 @@
+"""
+Generate per-radix ROM and carry tables for radix.c
+
+Usage: python3 genradix.py 2 8 10 16 36 > radix_tables.h
+
+For every base this checks, the same way test.py does, that the worst-case accumulator (every bit set)
+fits a slot both before and during the carry, and picks 8-bit slots when it can and 16-bit slots otherwise.
+"""
+
+import math
+import sys
+
+bitwidth = 32
+
+
+def toDigits(value, base, width):
+    digits = []
+    for _ in range(width):
+        digits.append(value % base)
+        value //= base
+    return digits[::-1]
+
+
+def worstCase(base, width):
+    digits = [0] * width
+    for power in range(bitwidth):
+        for i, digit in enumerate(toDigits(2**power, base, width)):
+            digits[i] += digit
+    largest = max(digits)
+    for i in range(width - 1, 0, -1):
+        digits[i-1] += digits[i] // base
+        digits[i] %= base
+        largest = max(largest, digits[i-1])
+    return largest
+
+
+def generate(base):
+    width = math.ceil(bitwidth * math.log(2) / math.log(base))
+    largest = worstCase(base, width)
+    if largest <= 255:
+        slotBits = 8
+    elif largest <= 65535:
+        slotBits = 16
+    else:
+        sys.exit(f"base {base}: worst case {largest} overflows a 16-bit slot")
+
+    slotsPerWord = 64 // slotBits
+    words = math.ceil(width / slotsPerWord)
+    slots = words * slotsPerWord
+    tableSize = 256 if slotBits == 8 else largest + 1
+    quotientType = "uint8_t" if (tableSize - 1) // base <= 255 else "uint16_t"
+
+    lines = [f"// base {base}: {width} digits, worst-case slot {largest}, {slotBits}-bit slots"]
+    lines.append(f"#define RADIX{base}_DIGITS {width}")
+    lines.append(f"#define RADIX{base}_WORDS {words}")
+    lines.append("typedef union {")
+    lines.append(f"    uint{slotBits}_t digits[{slots}];")
+    lines.append(f"    uint64_t words[{words}];")
+    lines.append(f"}} radix{base}_t;")
+    lines.append(f"static const radix{base}_t radixROM{base}[] = {{")
+    for power in range(bitwidth - 1, -1, -1):
+        digits = toDigits(2**power, base, width) + [0] * (slots - width)
+        end = "," if power else " "
+        lines.append(f"    {{ .digits = {{{', '.join(map(str, digits))}}} }}{end} // 2^{power}")
+    lines.append("};")
+    lines.append(f"static const {quotientType} radixQuotients{base}[] = {{{', '.join(str(v // base) for v in range(tableSize))}}};")
+    lines.append(f"static const uint8_t radixRemainders{base}[] = {{{', '.join(str(v % base) for v in range(tableSize))}}};")
+    return "\n".join(lines)
+
+
+bases = [int(arg) for arg in sys.argv[1:]] or [2, 8, 10, 16, 36]
+for base in bases:
+    if not 2 <= base <= 36:
+        sys.exit(f"base {base} is outside 2-36")
+
+print("// Generated by genradix.py, do not edit.")
+print(f"// python3 genradix.py {' '.join(map(str, bases))} > radix_tables.h")
+print()
+print("#define RADIX_BASES(X) " + " ".join(f"X({base})" for base in bases))
+print()
+for base in bases:
+    print(generate(base))
+    print()
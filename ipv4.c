@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "toothpaste.h"
+
+/*
+ * IPv4 formatting with four 8-bit engines running in one 64-bit register.
+ *
+ * Each octet gets a 16-bit lane, and the hundreds, tens and ones places each get their own register.
+ * For every bit position, (lanes >> bit) & laneOnes is 0 or 1 per lane, and multiplying that by a ROM digit
+ * adds the digit into exactly the lanes whose octet has the bit set, with no branch per octet.
+ * The worst-case ones place is 35, so the carry can divide by 10 with (x * 205) >> 11 per lane:
+ * the products stay under 2^16 and never spill into the next lane.
+ *
+ * The octets are written as four-byte "hto." groups, copied from the offset that skips the leading zeros;
+ * the trailing dot of the last group is overwritten by the terminator.
+ */
+
+#define laneOnes 0x0001000100010001ull
+#define laneMask 0x001f001f001f001full
+
+static uint64_t divideLanesBy10(uint64_t lanes) {
+    return ((lanes * 205) >> 11) & laneMask;
+}
+
+int format_ipv4(uint32_t address, char* out) {
+    uint64_t lanes = (uint64_t)(address >> 24)
+                   | (uint64_t)((address >> 16) & 0xff) << 16
+                   | (uint64_t)((address >> 8) & 0xff) << 32
+                   | (uint64_t)(address & 0xff) << 48;
+    uint64_t hundreds = 0, tens = 0, ones = 0, carry;
+    char* bufferPtr = out;
+
+    for (int bit = 0; bit < 8; bit++) {
+        uint64_t set = (lanes >> bit) & laneOnes;
+        const fullDecimal8_t* addend = &decimalROM8[7 - bit];
+        hundreds += set * addend->digits[0];
+        tens += set * addend->digits[1];
+        ones += set * addend->digits[2];
+    }
+
+    // squeeze, one place at a time for all four octets
+    carry = divideLanesBy10(ones);
+    ones -= carry * 10;
+    tens += carry;
+    carry = divideLanesBy10(tens);
+    tens -= carry * 10;
+    hundreds += carry;
+
+    for (int octet = 0; octet < 4; octet++) {
+        int shift = octet * 16;
+        uint32_t value = (lanes >> shift) & 0xff;
+        int length = 1 + (value >= 10) + (value >= 100);
+        char group[4] = {
+            (char)('0' + ((hundreds >> shift) & 0xff)),
+            (char)('0' + ((tens >> shift) & 0xff)),
+            (char)('0' + ((ones >> shift) & 0xff)),
+            '.'
+        };
+        memcpy(bufferPtr, group + 3 - length, 4);
+        bufferPtr += length + 1;
+    }
+    bufferPtr[-1] = '\0';
+    return bufferPtr - 1 - out;
+}
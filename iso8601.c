@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "toothpaste.h"
+
+/*
+ * ISO-8601 timestamps ("2024-03-01T12:34:56.789Z") from nanoseconds since the Unix epoch.
+ *
+ * Every field is fixed width, so there is no leading-zero scan: the engines already produce zero-padded
+ * digits and each field just copies the last few places out of the accumulator. The 8-bit engine covers
+ * month, day, hour, minute and second; the 32-bit one covers the year and the nanoseconds.
+ * The fraction is truncated, not rounded, so a timestamp never rolls over into the next second.
+ */
+
+static char* copyDigits(const uint8_t* digits, int width, int count, char* out) {
+    for (int decimalPtr = width - count; decimalPtr < width; decimalPtr++) *out++ = digits[decimalPtr] + '0';
+    return out;
+}
+
+static char* twoDigits(uint8_t value, char* out) {
+    return copyDigits(uitodec8(value).digits, 3, 2, out);
+}
+
+// days since 1970-01-01 to a proleptic Gregorian date, after Howard Hinnant's civil_from_days
+static void civilFromDays(int64_t days, int64_t* year, unsigned* month, unsigned* day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = (unsigned)(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shiftedMonth = (5 * dayOfYear + 2) / 153; // March is 0
+    *day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    *month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    *year = (int64_t)yearOfEra + era * 400 + (*month <= 2);
+}
+
+// "YYYY-MM-DDTHH:MM:SS", always 19 bytes: an int64_t of nanoseconds only spans the years 1677 to 2262
+static void formatPrefix(int64_t seconds, char* out) {
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    int64_t year;
+    unsigned month, day;
+
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        days--;
+    }
+    civilFromDays(days, &year, &month, &day);
+
+    out = copyDigits(uitodec((uint32_t)year).digits, 10, 4, out);
+    *out++ = '-';
+    out = twoDigits(month, out);
+    *out++ = '-';
+    out = twoDigits(day, out);
+    *out++ = 'T';
+    out = twoDigits(secondOfDay / 3600, out);
+    *out++ = ':';
+    out = twoDigits(secondOfDay / 60 % 60, out);
+    *out++ = ':';
+    twoDigits(secondOfDay % 60, out);
+}
+
+static int formatSuffix(uint32_t nanos, int fracDigits, char* out) {
+    char* bufferPtr = out;
+    if (fracDigits > 9) fracDigits = 9;
+    if (fracDigits > 0) {
+        *bufferPtr++ = '.';
+        // the nanoseconds are the last nine places; keep the leading `fracDigits` of them
+        bufferPtr = copyDigits(uitodec(nanos).digits, 10 - 9 + fracDigits, fracDigits, bufferPtr);
+    }
+    *bufferPtr++ = 'Z';
+    *bufferPtr = '\0';
+    return bufferPtr - out;
+}
+
+static void splitNanos(int64_t epochNanos, int64_t* seconds, uint32_t* nanos) {
+    int64_t remainder = epochNanos % 1000000000;
+    *seconds = epochNanos / 1000000000;
+    if (remainder < 0) {
+        remainder += 1000000000;
+        (*seconds)--;
+    }
+    *nanos = (uint32_t)remainder;
+}
+
+int format_iso8601(int64_t epoch_nanos, char* out, int frac_digits) {
+    int64_t seconds;
+    uint32_t nanos;
+    splitNanos(epoch_nanos, &seconds, &nanos);
+    formatPrefix(seconds, out);
+    return 19 + formatSuffix(nanos, frac_digits, out + 19);
+}
+
+int format_iso8601_cached(iso8601Cache_t* cache, int64_t epoch_nanos, char* out, int frac_digits) {
+    int64_t seconds;
+    uint32_t nanos;
+    splitNanos(epoch_nanos, &seconds, &nanos);
+    if (!cache->valid || cache->second != seconds) {
+        formatPrefix(seconds, cache->prefix);
+        cache->second = seconds;
+        cache->valid = 1;
+    }
+    memcpy(out, cache->prefix, 19);
+    return 19 + formatSuffix(nanos, frac_digits, out + 19);
+}
@@ -0,0 +1,82 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "toothpaste.h"
+
+/*
+ * Integer arrays straight to JSON ("[1,22,333]").
+ *
+ * The separators are written in the same pass as the digits, so there is no per-element string to stitch
+ * together afterwards. Digits become ASCII with one word-wide add of '0' per accumulator word instead of one
+ * add per byte; after that, each element is one memcpy from the first significant digit, with the comma
+ * included (the last one is overwritten by the closing bracket).
+ *
+ * Output is sized up front: TP_JSON_ARRAY_*_MAX(count) bytes always suffice, and the functions refuse to start
+ * (returning -1) with less, so the inner loop never checks for room.
+ */
+
+#define asciiZeros 0x3030303030303030ull
+
+static char* appendU32(uint32_t value, char* out) {
+    fullDecimal32_t decimal = uitodec(value);
+    int decimalPtr = 0;
+    while (decimalPtr < 9 && decimal.digits[decimalPtr] == 0) decimalPtr++;
+    decimal.arith.high += asciiZeros;
+    decimal.arith.low += (uint16_t)asciiZeros;
+    memcpy(out, decimal.digits + decimalPtr, 10 - decimalPtr);
+    out += 10 - decimalPtr;
+    *out++ = ',';
+    return out;
+}
+
+static char* appendU64(uint64_t value, char* out) {
+    fullDecimal64_t decimal = uitodec64(value);
+    int decimalPtr = 0;
+    while (decimalPtr < 19 && decimal.digits[decimalPtr] == 0) decimalPtr++;
+    decimal.arith.high += asciiZeros;
+    decimal.arith.mid += asciiZeros;
+    decimal.arith.low += (uint32_t)asciiZeros;
+    memcpy(out, decimal.digits + decimalPtr, 20 - decimalPtr);
+    out += 20 - decimalPtr;
+    *out++ = ',';
+    return out;
+}
+
+static int64_t finish(char* out, char* bufferPtr, size_t count) {
+    // bufferPtr is past a trailing comma unless the array was empty
+    if (count) bufferPtr--;
+    *bufferPtr++ = ']';
+    *bufferPtr = '\0';
+    return bufferPtr - out;
+}
+
+int64_t tp_json_array_u32(const uint32_t* values, size_t count, char* out, size_t capacity) {
+    char* bufferPtr = out;
+    if (capacity < TP_JSON_ARRAY_U32_MAX(count)) return -1;
+    *bufferPtr++ = '[';
+    for (size_t i = 0; i < count; i++) bufferPtr = appendU32(values[i], bufferPtr);
+    return finish(out, bufferPtr, count);
+}
+
+int64_t tp_json_array_u64(const uint64_t* values, size_t count, char* out, size_t capacity) {
+    char* bufferPtr = out;
+    if (capacity < TP_JSON_ARRAY_U64_MAX(count)) return -1;
+    *bufferPtr++ = '[';
+    for (size_t i = 0; i < count; i++) bufferPtr = appendU64(values[i], bufferPtr);
+    return finish(out, bufferPtr, count);
+}
+
+int64_t tp_json_array_i64(const int64_t* values, size_t count, char* out, size_t capacity) {
+    char* bufferPtr = out;
+    if (capacity < TP_JSON_ARRAY_I64_MAX(count)) return -1;
+    *bufferPtr++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        uint64_t magnitude = (uint64_t)values[i];
+        if (values[i] < 0) {
+            *bufferPtr++ = '-';
+            magnitude = 0 - magnitude;
+        }
+        bufferPtr = appendU64(magnitude, bufferPtr);
+    }
+    return finish(out, bufferPtr, count);
+}
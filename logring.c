@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "toothpaste.h"
+
+/*
+ * Deferred formatting: producers push raw integers into a ring and a background thread does the converting.
+ *
+ * The ring is Dmitry Vyukov's bounded queue. Every cell carries a sequence number that says whose turn it is:
+ * a producer may fill cell `pos` once its sequence equals `pos`, and the consumer may read it once the sequence
+ * is `pos + 1`. Producers claim positions with a compare-and-swap on `enqueuePos`; the single consumer owns
+ * `dequeuePos` outright. Pushing never blocks or allocates, it fails when the ring is full.
+ *
+ * The consumer drains up to `batchSize` entries at a time, converts them back to back into one text buffer
+ * (one value per line) and hands the whole buffer to the sink, so the tables stay warm across a batch and the
+ * sink is called once per batch instead of once per value.
+ */
+
+#define batchSize 256
+
+typedef struct {
+    atomic_size_t sequence;
+    uint64_t value;
+    int tag;
+} logCell_t;
+
+struct logRing {
+    logCell_t* cells;
+    size_t mask;
+    atomic_size_t enqueuePos;
+    size_t dequeuePos;
+    atomic_bool stopping;
+    logSink_t sink;
+    void* context;
+    pthread_t consumer;
+    char text[batchSize * 21];
+};
+
+int logring_push(logRing_t* ring, uint64_t value, int tag) {
+    size_t pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+    for (;;) {
+        logCell_t* cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->value = value;
+                cell->tag = tag;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 0;
+            }
+            // the failed CAS reloaded `pos`
+        } else if (difference < 0) {
+            return -1; // full: the consumer hasn't released this cell from the previous lap yet
+        } else {
+            pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+static int formatEntry(uint64_t value, int tag, char* out) {
+    switch (tag) {
+    case TP_LOG_U32:
+        return fillBuffer(uitodec((uint32_t)value), out);
+    case TP_LOG_I64:
+        if ((int64_t)value < 0) {
+            *out = '-';
+            return 1 + fillBuffer64(uitodec64(-value), out + 1);
+        }
+        return fillBuffer64(uitodec64(value), out);
+    default:
+        return fillBuffer64(uitodec64(value), out);
+    }
+}
+
+// converts whatever is ready, at most one batch; returns how many entries it took
+static int drainBatch(logRing_t* ring) {
+    char* bufferPtr = ring->text;
+    int count = 0;
+    while (count < batchSize) {
+        logCell_t* cell = &ring->cells[ring->dequeuePos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        if (sequence != ring->dequeuePos + 1) break;
+        bufferPtr += formatEntry(cell->value, cell->tag, bufferPtr);
+        *bufferPtr++ = '\n';
+        atomic_store_explicit(&cell->sequence, ring->dequeuePos + ring->mask + 1, memory_order_release);
+        ring->dequeuePos++;
+        count++;
+    }
+    if (count) ring->sink(ring->text, bufferPtr - ring->text, ring->context);
+    return count;
+}
+
+static void* consumerMain(void* argument) {
+    logRing_t* ring = argument;
+    struct timespec idle = {0, 50000};
+    for (;;) {
+        bool stopping = atomic_load_explicit(&ring->stopping, memory_order_acquire);
+        if (drainBatch(ring)) continue;
+        // only stop once a pass after seeing the flag found the ring empty
+        if (stopping) return NULL;
+        nanosleep(&idle, NULL);
+    }
+}
+
+logRing_t* logring_create(size_t capacity, logSink_t sink, void* context) {
+    logRing_t* ring;
+    size_t cells = 2;
+    while (cells < capacity) cells <<= 1;
+
+    ring = malloc(sizeof(logRing_t));
+    if (!ring) return NULL;
+    ring->cells = malloc(cells * sizeof(logCell_t));
+    if (!ring->cells) {
+        free(ring);
+        return NULL;
+    }
+    for (size_t i = 0; i < cells; i++) atomic_init(&ring->cells[i].sequence, i);
+    ring->mask = cells - 1;
+    atomic_init(&ring->enqueuePos, 0);
+    ring->dequeuePos = 0;
+    atomic_init(&ring->stopping, false);
+    ring->sink = sink;
+    ring->context = context;
+    if (pthread_create(&ring->consumer, NULL, consumerMain, ring)) {
+        free(ring->cells);
+        free(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void logring_destroy(logRing_t* ring) {
+    atomic_store_explicit(&ring->stopping, true, memory_order_release);
+    pthread_join(ring->consumer, NULL);
+    free(ring->cells);
+    free(ring);
+}
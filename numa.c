@@ -0,0 +1,223 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "toothpaste.h"
+#include "toothpaste_core.h"
+
+/*
+ * NUMA-aware form of the column fill in columnar.c, for multi-socket machines.
+ *
+ * Three things change from tp_column_*_fill:
+ *   - every worker is pinned to a CPU, spread round-robin over the nodes in /sys/devices/system/node
+ *   - each node gets its own copy of the ROMs and the carry tables, written by a thread pinned to that node so
+ *     the kernel's first-touch policy places the pages there; workers run the engine cores from toothpaste_core.h
+ *     on their node's replica
+ *   - the data buffer is mapped here and never touched before the workers run, so each worker's rows land in
+ *     pages on its own node
+ * No libnuma: placement relies only on first touch, which is the default policy. If the node directory can't be
+ * read there is one node holding every online CPU, and if pinning fails the worker simply runs unpinned.
+ *
+ * TP_NUMA_REMOTE deliberately does it wrong (every worker uses the next node's tables and the calling thread
+ * touches the whole buffer first), so benchmarks can show what locality is worth. On one node it changes only
+ * the output placement.
+ */
+
+#define maxNodes 64
+#define maxCpus 1024
+#define maxWorkers 256
+
+typedef struct {
+    fullDecimal32_t rom[32];
+    fullDecimal64_t rom64[64];
+    uint8_t quotients[256];
+    uint8_t remainders[256];
+} conversionTables_t;
+
+typedef struct {
+    int count;
+    int cpuCounts[maxNodes];
+    int* cpus[maxNodes];
+} topology_t;
+
+static topology_t topology;
+static pthread_once_t topologyOnce = PTHREAD_ONCE_INIT;
+
+static conversionTables_t* nodeTables[maxNodes];
+static pthread_once_t nodeTablesOnce = PTHREAD_ONCE_INIT;
+
+// parses a sysfs cpu list such as "0-3,8-11" into `cpus`; returns how many it found
+static int parseCpuList(const char* list, int* cpus) {
+    int count = 0;
+    while (*list && *list != '\n') {
+        char* end;
+        long first = strtol(list, &end, 10), last = first;
+        if (end == list) break;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+        for (long cpu = first; cpu <= last && count < maxCpus; cpu++) cpus[count++] = (int)cpu;
+        list = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+static void discoverTopology(void) {
+    char path[64], list[4096];
+    for (int node = 0; node < maxNodes; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* file = fopen(path, "r");
+        if (!file) continue;
+        int cpus[maxCpus], count = fgets(list, sizeof(list), file) ? parseCpuList(list, cpus) : 0;
+        fclose(file);
+        if (!count) continue; // memory-only nodes have nothing to run workers on
+        topology.cpus[topology.count] = malloc(count * sizeof(int));
+        memcpy(topology.cpus[topology.count], cpus, count * sizeof(int));
+        topology.cpuCounts[topology.count++] = count;
+    }
+    if (!topology.count) {
+        int count = sysconf(_SC_NPROCESSORS_ONLN);
+        if (count < 1) count = 1;
+        topology.cpus[0] = malloc(count * sizeof(int));
+        for (int cpu = 0; cpu < count; cpu++) topology.cpus[0][cpu] = cpu;
+        topology.cpuCounts[0] = count;
+        topology.count = 1;
+    }
+}
+
+int tp_numa_nodes(void) {
+    pthread_once(&topologyOnce, discoverTopology);
+    return topology.count;
+}
+
+// fresh anonymous pages, so whichever thread writes them first decides where they live
+static void* mapUntouched(size_t size) {
+    void* pages = mmap(NULL, size ? size : 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return pages == MAP_FAILED ? NULL : pages;
+}
+
+static void pinToCpu(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); // unpinned is still correct, just not local
+}
+
+// copies the tables into memory on one node, from a thread pinned there
+static void* buildTablesMain(void* argument) {
+    int node = (int)(intptr_t)argument;
+    pinToCpu(topology.cpus[node][0]);
+    conversionTables_t* tables = mapUntouched(sizeof(conversionTables_t));
+    if (tables) {
+        memcpy(tables->rom, decimalROM, sizeof(tables->rom));
+        memcpy(tables->rom64, decimalROM64, sizeof(tables->rom64));
+        memcpy(tables->quotients, quotients, sizeof(tables->quotients));
+        memcpy(tables->remainders, remainders, sizeof(tables->remainders));
+    }
+    nodeTables[node] = tables;
+    return NULL;
+}
+
+// one replica per node, built once and kept; a node whose builder couldn't run has none
+static void buildNodeTables(void) {
+    pthread_t builders[maxNodes];
+    int started[maxNodes];
+    for (int node = 0; node < topology.count; node++) {
+        started[node] = !pthread_create(&builders[node], NULL, buildTablesMain, (void*)(intptr_t)node);
+    }
+    for (int node = 0; node < topology.count; node++) {
+        if (started[node]) pthread_join(builders[node], NULL);
+    }
+}
+
+typedef struct {
+    const void* values;
+    int wide;
+    int remote;
+    size_t begin;
+    size_t end;
+    const int32_t* offsets;
+    char* data;
+    int node;
+    int cpu;
+} numaRange_t;
+
+static void* numaFillMain(void* argument) {
+    numaRange_t* range = argument;
+    const conversionTables_t* tables = nodeTables[range->remote ? (range->node + 1) % topology.count : range->node];
+
+    if (!tables) return NULL; // left for the caller to redo with the shared tables
+    pinToCpu(range->cpu);
+
+    for (size_t row = range->begin; row < range->end; row++) {
+        char* out = range->data + range->offsets[row];
+        int length = range->offsets[row + 1] - range->offsets[row];
+        if (range->wide) {
+            fullDecimal64_t decimal = uitodec64Tables(((const uint64_t*)range->values)[row], tables->rom64, tables->quotients, tables->remainders);
+            for (int d = 20 - length; d < 20; d++) *out++ = decimal.digits[d] + '0';
+        } else {
+            fullDecimal32_t decimal = uitodecTables(((const uint32_t*)range->values)[row], tables->rom, tables->quotients, tables->remainders);
+            for (int d = 10 - length; d < 10; d++) *out++ = decimal.digits[d] + '0';
+        }
+    }
+    range->end = range->begin; // done
+    return NULL;
+}
+
+static char* numaColumn(const void* values, int wide, size_t count, int32_t* offsets, size_t* dataSize, int threads, int flags) {
+    pthread_t workers[maxWorkers];
+    numaRange_t ranges[maxWorkers];
+    int started[maxWorkers] = {0};
+    size_t size = wide ? tp_column_u64_measure(values, count, offsets) : tp_column_u32_measure(values, count, offsets);
+    char* data;
+
+    if (size == SIZE_MAX) return NULL;
+    data = mapUntouched(size);
+    if (!data) return NULL;
+    pthread_once(&topologyOnce, discoverTopology);
+    pthread_once(&nodeTablesOnce, buildNodeTables);
+    if (flags & TP_NUMA_REMOTE) memset(data, 0, size);
+
+    if (threads < 1) {
+        threads = 0;
+        for (int node = 0; node < topology.count; node++) threads += topology.cpuCounts[node];
+    }
+    if (threads > maxWorkers) threads = maxWorkers;
+    if ((size_t)threads > count / 4096 + 1) threads = count / 4096 + 1;
+
+    // worker t runs on node t % nodes, cycling through that node's CPUs
+    for (int t = 0; t < threads; t++) {
+        int node = t % topology.count;
+        int cpu = topology.cpus[node][(t / topology.count) % topology.cpuCounts[node]];
+        ranges[t] = (numaRange_t){values, wide, !!(flags & TP_NUMA_REMOTE), count * t / threads, count * (t + 1) / threads,
+                                  offsets, data, node, cpu};
+        started[t] = !pthread_create(&workers[t], NULL, numaFillMain, &ranges[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) pthread_join(workers[t], NULL);
+    }
+    // whatever a worker couldn't do (no thread, or no memory for its tables) is filled here, with the shared tables
+    for (int t = 0; t < threads; t++) {
+        if (ranges[t].begin == ranges[t].end) continue;
+        if (wide) tp_column_u64_fill((const uint64_t*)values + ranges[t].begin, ranges[t].end - ranges[t].begin, offsets + ranges[t].begin, data, 1);
+        else tp_column_u32_fill((const uint32_t*)values + ranges[t].begin, ranges[t].end - ranges[t].begin, offsets + ranges[t].begin, data, 1);
+    }
+    *dataSize = size;
+    return data;
+}
+
+char* tp_numa_column_u32(const uint32_t* values, size_t count, int32_t* offsets, size_t* dataSize, int threads, int flags) {
+    return numaColumn(values, 0, count, offsets, dataSize, threads, flags);
+}
+
+char* tp_numa_column_u64(const uint64_t* values, size_t count, int32_t* offsets, size_t* dataSize, int threads, int flags) {
+    return numaColumn(values, 1, count, offsets, dataSize, threads, flags);
+}
+
+void tp_numa_free(char* data, size_t dataSize) {
+    if (data) munmap(data, dataSize ? dataSize : 1);
+}
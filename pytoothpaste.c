@@ -0,0 +1,338 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "toothpaste.h"
+
+/*
+ * Python bindings: integer arrays to delimited decimal text.
+ * Build: python3 setup.py build_ext --inplace
+ *
+ *     import array, pytoothpaste
+ *     pytoothpaste.format(array.array("q", [1, -2, 3]))            # b"1\n-2\n3\n"
+ *     pytoothpaste.format(numpy_array, sep=b",", end=b"", threads=0)
+ *     written = pytoothpaste.format_into(values, bytearray_or_mmap)
+ *
+ * Anything exporting the buffer protocol with an integer item format works: array.array, numpy arrays (any
+ * C-contiguous shape, read in row-major order), memoryviews of them. `sep` goes between values and `end` after
+ * the last one; threads=0 means one per CPU.
+ *
+ * Two passes, both without the GIL. The first splits the values into one range per thread and counts the
+ * characters each range needs, so the result is allocated at its exact size; the second converts every range
+ * straight into its place. Magnitudes that fit in 32 bits go through uitoa_adaptive_site, one site per range,
+ * so each thread settles on whichever engine suits its data; the cost model is calibrated for this machine the
+ * first time the module converts anything, so importing it costs nothing. Larger magnitudes are cut into 9-digit pieces and converted with the pairs engine,
+ * which keeps those pieces out of the sites' statistics.
+ */
+
+typedef struct {
+    int width;    // bytes per item
+    int isSigned;
+} itemType_t;
+
+typedef struct {
+    const char* items;
+    itemType_t type;
+    size_t begin;
+    size_t end;
+    const char* sep;
+    size_t sepLength;
+    const char* last; // what follows the range's final value: `end` for the last range, `sep` for the others
+    size_t lastLength;
+    size_t size;      // characters for this range, separators included
+    char* out;
+    adaptiveSite_t site;
+} range_t;
+
+static const uint64_t powersOf10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+// as in columnar.c
+static int digitCount(uint64_t value) {
+    value |= 1;
+    int bits = 64 - __builtin_clzll(value);
+    int estimate = (bits * 1233) >> 12;
+    return estimate + 1 - (value < powersOf10[estimate]);
+}
+
+// the struct module's native integer codes, with an optional byte-order prefix that must match this machine
+static int parseItemType(const char* format, Py_ssize_t itemSize, itemType_t* type) {
+    if (!format) format = "B";
+    if (*format == '@' || *format == '=') format++;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    else if (*format == '<') format++;
+#else
+    else if (*format == '>' || *format == '!') format++;
+#endif
+    if (!format[0] || format[1] || !strchr("bBhHiIlLqQnN", format[0])) return -1;
+    if (itemSize != 1 && itemSize != 2 && itemSize != 4 && itemSize != 8) return -1;
+    type->width = (int)itemSize;
+    type->isSigned = !!strchr("bhilqn", format[0]);
+    return 0;
+}
+
+// |item| and whether it was negative
+static uint64_t readItem(const char* item, itemType_t type, int* negative) {
+    uint64_t raw = 0;
+    int64_t value;
+    switch (type.width) {
+    case 1: raw = *(const uint8_t*)item; value = *(const int8_t*)item; break;
+    case 2: { uint16_t v; memcpy(&v, item, 2); raw = v; value = (int16_t)v; break; }
+    case 4: { uint32_t v; memcpy(&v, item, 4); raw = v; value = (int32_t)v; break; }
+    default: memcpy(&raw, item, 8); value = (int64_t)raw; break;
+    }
+    *negative = type.isSigned && value < 0;
+    if (!type.isSigned) return raw;
+    return *negative ? 0 - (uint64_t)value : (uint64_t)value;
+}
+
+// adding 10^9 to a piece below 10^9 and dropping the leading '1' gives its zero-padded 9 digits
+static int convertPiece(uint32_t piece, char* out) {
+    char text[11];
+    uitoa_pairs(piece + 1000000000, text);
+    memcpy(out, text + 1, 9);
+    return 9;
+}
+
+// writes the digits of `magnitude` and a terminator into `out`, which has room for 21
+static int convertMagnitude(adaptiveSite_t* site, uint64_t magnitude, char* out) {
+    uint64_t high = magnitude / 1000000000;
+    int length;
+    if (magnitude <= UINT32_MAX) return uitoa_adaptive_site(site, (uint32_t)magnitude, out);
+    if (high <= UINT32_MAX) {
+        length = uitoa_pairs((uint32_t)high, out);
+    } else {
+        length = uitoa_pairs((uint32_t)(high / 1000000000), out);
+        length += convertPiece(high % 1000000000, out + length);
+    }
+    length += convertPiece(magnitude % 1000000000, out + length);
+    out[length] = '\0';
+    return length;
+}
+
+// only the single range of an empty input is ever empty, and that still gets `end`
+static void measureRange(range_t* range) {
+    size_t size = range->lastLength;
+    for (size_t i = range->begin; i < range->end; i++) {
+        int negative;
+        uint64_t magnitude = readItem(range->items + i * range->type.width, range->type, &negative);
+        size += negative + digitCount(magnitude);
+    }
+    if (range->end > range->begin) size += (range->end - range->begin - 1) * range->sepLength;
+    range->size = size;
+}
+
+static void fillRange(range_t* range) {
+    char* bufferPtr = range->out;
+    char text[21]; // the engines' terminator mustn't land in the next range, which another thread is writing
+    for (size_t i = range->begin; i < range->end; i++) {
+        int negative, length;
+        uint64_t magnitude = readItem(range->items + i * range->type.width, range->type, &negative);
+        if (negative) *bufferPtr++ = '-';
+        length = convertMagnitude(&range->site, magnitude, text);
+        memcpy(bufferPtr, text, length);
+        bufferPtr += length;
+        if (i + 1 < range->end) {
+            memcpy(bufferPtr, range->sep, range->sepLength);
+            bufferPtr += range->sepLength;
+        } else {
+            memcpy(bufferPtr, range->last, range->lastLength);
+            bufferPtr += range->lastLength;
+        }
+    }
+    if (range->begin == range->end) memcpy(bufferPtr, range->last, range->lastLength);
+}
+
+static void* measureMain(void* argument) {
+    measureRange(argument);
+    return NULL;
+}
+
+static void* fillMain(void* argument) {
+    fillRange(argument);
+    return NULL;
+}
+
+// runs `work` over every range, on the calling thread too; ranges whose thread can't start run here
+static void runRanges(range_t* ranges, int threads, void* (*work)(void*)) {
+    pthread_t workers[64];
+    int started[64] = {0};
+    for (int t = 1; t < threads; t++) started[t] = !pthread_create(&workers[t], NULL, work, &ranges[t]);
+    for (int t = 0; t < threads; t++) {
+        if (!started[t]) work(&ranges[t]);
+    }
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(workers[t], NULL);
+    }
+}
+
+typedef struct {
+    Py_buffer values;
+    itemType_t type;
+    size_t count;
+    range_t ranges[64];
+    int threads;
+    size_t size;
+} job_t;
+
+static int jobStart(job_t* job, PyObject* values, const Py_buffer* sep, const Py_buffer* end, int threads) {
+    if (PyObject_GetBuffer(values, &job->values, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0) return -1;
+    if (parseItemType(job->values.format, job->values.itemsize, &job->type) < 0) {
+        PyErr_Format(PyExc_TypeError, "expected a buffer of native integers, got format '%s'",
+                     job->values.format ? job->values.format : "B");
+        PyBuffer_Release(&job->values);
+        return -1;
+    }
+    job->count = job->values.len / job->values.itemsize;
+
+    if (threads < 1) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > 64) threads = 64;
+    if ((size_t)threads > job->count / 16384 + 1) threads = (int)(job->count / 16384 + 1); // not worth a thread below that
+    job->threads = threads;
+    for (int t = 0; t < threads; t++) {
+        int isLast = t == threads - 1;
+        job->ranges[t] = (range_t){
+            .items = job->values.buf,
+            .type = job->type,
+            .begin = job->count * t / threads,
+            .end = job->count * (t + 1) / threads,
+            .sep = sep->buf,
+            .sepLength = sep->len,
+            .last = isLast ? end->buf : sep->buf,
+            .lastLength = isLast ? end->len : sep->len,
+        };
+    }
+    return 0;
+}
+
+static pthread_once_t calibrateOnce = PTHREAD_ONCE_INIT;
+
+static void jobMeasure(job_t* job) {
+    // before any conversion thread starts, as toothpaste.h asks; other callers wait here until it's done
+    pthread_once(&calibrateOnce, tp_adaptive_calibrate);
+    job->size = 0;
+    runRanges(job->ranges, job->threads, measureMain);
+    for (int t = 0; t < job->threads; t++) job->size += job->ranges[t].size;
+}
+
+static void jobFill(job_t* job, char* out) {
+    for (int t = 0; t < job->threads; t++) {
+        job->ranges[t].out = out;
+        out += job->ranges[t].size;
+    }
+    runRanges(job->ranges, job->threads, fillMain);
+}
+
+PyDoc_STRVAR(format_doc,
+"format(values, sep=b'\\n', end=b'\\n', threads=1) -> bytes\n\n"
+"Decimal text of every integer in `values`, with `sep` between them and `end` after the last.\n"
+"threads=0 uses one thread per CPU.");
+
+static PyObject* pytoothpaste_format(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"values", "sep", "end", "threads", NULL};
+    PyObject* values;
+    Py_buffer sep = {0}, end = {0};
+    int threads = 1;
+    job_t* job;
+    PyObject* result = NULL;
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|y*y*i:format", keywords, &values, &sep, &end, &threads)) return NULL;
+    if (!sep.obj) PyBuffer_FillInfo(&sep, NULL, "\n", 1, 1, PyBUF_SIMPLE);
+    if (!end.obj) PyBuffer_FillInfo(&end, NULL, "\n", 1, 1, PyBUF_SIMPLE);
+    job = PyMem_Calloc(1, sizeof(job_t));
+    if (!job) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    if (jobStart(job, values, &sep, &end, threads) < 0) goto done;
+
+    Py_BEGIN_ALLOW_THREADS
+    jobMeasure(job);
+    Py_END_ALLOW_THREADS
+    if (job->size > PY_SSIZE_T_MAX) {
+        PyErr_NoMemory();
+    } else if ((result = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)job->size))) {
+        char* out = PyBytes_AS_STRING(result);
+        Py_BEGIN_ALLOW_THREADS
+        jobFill(job, out);
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&job->values);
+
+done:
+    PyMem_Free(job);
+    PyBuffer_Release(&sep);
+    PyBuffer_Release(&end);
+    return result;
+}
+
+PyDoc_STRVAR(format_into_doc,
+"format_into(values, out, sep=b'\\n', end=b'\\n', threads=1) -> int\n\n"
+"Like format(), but writes into the writable buffer `out` and returns the number of bytes written.\n"
+"Raises ValueError, leaving `out` untouched, if the text doesn't fit.");
+
+static PyObject* pytoothpaste_format_into(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"values", "out", "sep", "end", "threads", NULL};
+    PyObject* values;
+    Py_buffer out = {0}, sep = {0}, end = {0};
+    int threads = 1;
+    job_t* job;
+    PyObject* result = NULL;
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Ow*|y*y*i:format_into", keywords, &values, &out, &sep, &end, &threads)) return NULL;
+    if (!sep.obj) PyBuffer_FillInfo(&sep, NULL, "\n", 1, 1, PyBUF_SIMPLE);
+    if (!end.obj) PyBuffer_FillInfo(&end, NULL, "\n", 1, 1, PyBUF_SIMPLE);
+    job = PyMem_Calloc(1, sizeof(job_t));
+    if (!job) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    if (jobStart(job, values, &sep, &end, threads) < 0) goto done;
+
+    Py_BEGIN_ALLOW_THREADS
+    jobMeasure(job);
+    if (job->size <= (size_t)out.len) jobFill(job, out.buf);
+    Py_END_ALLOW_THREADS
+    if (job->size > (size_t)out.len) {
+        PyErr_Format(PyExc_ValueError, "output needs %zu bytes, buffer has %zd", job->size, out.len);
+    } else {
+        result = PyLong_FromSize_t(job->size);
+    }
+    PyBuffer_Release(&job->values);
+
+done:
+    PyMem_Free(job);
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&sep);
+    PyBuffer_Release(&end);
+    return result;
+}
+
+static PyMethodDef methods[] = {
+    {"format", (PyCFunction)(void (*)(void))pytoothpaste_format, METH_VARARGS | METH_KEYWORDS, format_doc},
+    {"format_into", (PyCFunction)(void (*)(void))pytoothpaste_format_into, METH_VARARGS | METH_KEYWORDS, format_into_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "pytoothpaste",
+    "Integer arrays to decimal text with the toothpaste engine.",
+    -1,
+    methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit_pytoothpaste(void) {
+    return PyModule_Create(&module);
+}
@@ -0,0 +1,80 @@
+#include <stdint.h>
+
+#include "toothpaste.h"
+#include "radix_tables.h"
+
+/*
+ * The toothpaste engine in other bases.
+ *
+ * Nothing in the deferred-carry trick is specific to ten: each base gets a ROM holding every power of two
+ * written in that base, plus quotient and remainder tables for its carry. genradix.py generates those and
+ * checks the worst-case slot, so a base whose slots would overflow a byte (36, for instance) gets 16-bit slots.
+ * The accumulator is added a 64-bit word at a time whatever the slot width.
+ *
+ * RADIX_ENGINE stamps out one function per generated base; uitoa_radix dispatches between them at runtime
+ * and uses plain division for bases that weren't generated.
+ */
+
+static const char radixAlphabet[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+#define RADIX_ENGINE(base) \
+int uitoa_radix##base(uint32_t i, char* a) { \
+    radix##base##_t accumulator = {{0}}; \
+    int count = 0; \
+    int decimalPtr = 0; \
+    int bufferPtr = 0; \
+    while (i) { \
+        if (i & 0x80000000u) { \
+            for (int w = 0; w < RADIX##base##_WORDS; w++) accumulator.words[w] += radixROM##base[count].words[w]; \
+        } \
+        count++; \
+        i <<= 1; \
+    } \
+    for (int d = RADIX##base##_DIGITS - 1; d > 0; d--) { \
+        accumulator.digits[d-1] += radixQuotients##base[accumulator.digits[d]]; \
+        accumulator.digits[d] = radixRemainders##base[accumulator.digits[d]]; \
+    } \
+    while (decimalPtr < RADIX##base##_DIGITS - 1 && accumulator.digits[decimalPtr] == 0) decimalPtr++; \
+    while (decimalPtr < RADIX##base##_DIGITS) a[bufferPtr++] = radixAlphabet[accumulator.digits[decimalPtr++]]; \
+    a[bufferPtr] = '\0'; \
+    return bufferPtr; \
+}
+
+RADIX_BASES(RADIX_ENGINE)
+
+static int uitoaRadixDivision(uint32_t i, int base, char* a) {
+    char reversed[32];
+    int length = 0;
+    do {
+        reversed[length++] = radixAlphabet[i % base];
+        i /= base;
+    } while (i);
+    for (int bufferPtr = 0; bufferPtr < length; bufferPtr++) a[bufferPtr] = reversed[length - 1 - bufferPtr];
+    a[length] = '\0';
+    return length;
+}
+
+int uitoa_radix(uint32_t i, int base, char* a) {
+    switch (base) {
+#define RADIX_CASE(b) case b: return uitoa_radix##b(i, a);
+    RADIX_BASES(RADIX_CASE)
+#undef RADIX_CASE
+    }
+    if (base < 2 || base > 36) return -1;
+    return uitoaRadixDivision(i, base, a);
+}
+
+int uitoa_radix_tables(int base, engineTable_t tables[TP_MAX_ENGINE_TABLES]) {
+    switch (base) {
+#define RADIX_TABLES(b) \
+    case b: \
+        tables[0] = (engineTable_t){radixROM##b, sizeof(radixROM##b)}; \
+        tables[1] = (engineTable_t){radixQuotients##b, sizeof(radixQuotients##b)}; \
+        tables[2] = (engineTable_t){radixRemainders##b, sizeof(radixRemainders##b)}; \
+        tables[3] = (engineTable_t){radixAlphabet, sizeof(radixAlphabet)}; \
+        return 4;
+    RADIX_BASES(RADIX_TABLES)
+#undef RADIX_TABLES
+    }
+    return -1;
+}
@@ -0,0 +1,18 @@
+"""
+Builds the pytoothpaste extension: python3 setup.py build_ext --inplace
+"""
+
+from setuptools import setup, Extension
+
+setup(
+    name="pytoothpaste",
+    version="0.1",
+    ext_modules=[
+        Extension(
+            "pytoothpaste",
+            sources=["pytoothpaste.c", "toothpaste.c", "engines.c", "adaptive.c"],
+            extra_compile_args=["-O2", "-pthread"],
+            extra_link_args=["-pthread"],
+        )
+    ],
+)
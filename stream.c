@@ -0,0 +1,384 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "toothpaste.h"
+
+/*
+ * Streaming converter: binary integers on stdin, one decimal per line on stdout. Works on pipes, where the
+ * input can't be mapped, so it is built for throughput rather than latency.
+ * Build: cc -O2 stream.c toothpaste.c asyncwrite.c -pthread -o stream
+ * Usage: producer | stream [-w 4|8] [-s] [-j workers] [-b block KiB] [-d depth] [-o file [-u writes] [-P]] [-q] > out.txt
+ *
+ * -w is the width of each integer in bytes (native byte order, default 4), -s reads them as signed.
+ * -o writes to a file through asyncwrite.c instead of to stdout, with up to -u writes in flight (default 3) so
+ * the writer never waits on the disk while blocks are ready; -P forces its pwrite fallback for comparison.
+ *
+ * Three stages, each on its own thread(s):
+ *   reader     fills blocks from stdin with large reads and deals them round-robin to the converters
+ *   converters turn one block of integers into one block of text
+ *   writer     takes blocks back in the same round-robin order, so the output keeps the input's order,
+ *              and writes each block's text with as few write calls as the kernel allows
+ * Every hand-off is a single-producer single-consumer ring, so no stage ever takes a lock. A stage that finds
+ * its ring empty spins briefly and then sleeps on a futex that the next push wakes, so an idle pipe costs no
+ * CPU. Written blocks go
+ * back to the reader through one more ring; the reader only ever fills blocks from that pool, which caps the
+ * memory in flight at `workers * depth` blocks of input and text.
+ *
+ * When the input ends the reader sends every converter a NULL, the converters pass it on, and the writer stops
+ * at the first NULL it meets in round-robin order, which can only come after the last block.
+ * Throughput is reported on stderr unless -q is given.
+ */
+
+typedef struct {
+    size_t count;  // integers in `input`
+    size_t length; // characters in `text`
+    uint8_t* input;
+    char* text;
+} block_t;
+
+typedef struct {
+    block_t** slots;
+    size_t mask;
+    _Alignas(64) atomic_size_t head; // next slot to read, owned by the consumer
+    _Alignas(64) atomic_size_t tail; // next slot to write, owned by the producer
+    atomic_uint pushes;              // futex word, bumped by every push
+    atomic_int parked;               // set while the consumer may be asleep on `pushes`
+} spscQueue_t;
+
+typedef struct {
+    int width;
+    int isSigned;
+    int workers;
+    size_t blockBytes;
+    spscQueue_t freeBlocks;
+    spscQueue_t* toConverter;
+    spscQueue_t* toWriter;
+    const char* outputPath;
+    int writeDepth;
+    int writeFlags;
+    asyncWriterStats_t writeStats;
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    atomic_int failed;
+} stream_t;
+
+static void queueInit(spscQueue_t* queue, size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    queue->slots = calloc(size, sizeof(block_t*));
+    queue->mask = size - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->pushes, 0);
+    atomic_init(&queue->parked, 0);
+}
+
+// the queues are sized to hold every block, so a push never has to wait
+static void queuePush(spscQueue_t* queue, block_t* block) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    queue->slots[tail & queue->mask] = block;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    // pairs with the consumer setting `parked` before it reads `pushes`: either it sees this push or we see it parked
+    atomic_fetch_add(&queue->pushes, 1);
+    if (atomic_load(&queue->parked)) syscall(SYS_futex, &queue->pushes, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// returns 0 if the queue is empty
+static int queueTryPop(spscQueue_t* queue, block_t** block) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (atomic_load_explicit(&queue->tail, memory_order_acquire) == head) return 0;
+    *block = queue->slots[head & queue->mask];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return 1;
+}
+
+// spins briefly, since a stage that waits usually waits for another stage's whole block, then sleeps until the
+// next push or until `timeout` (NULL for none) runs out; returns 0 if the queue is still empty
+static int queueWaitPop(spscQueue_t* queue, block_t** block, const struct timespec* timeout) {
+    for (int spins = 0; spins < 64; spins++) {
+        if (queueTryPop(queue, block)) return 1;
+    }
+    atomic_store(&queue->parked, 1);
+    unsigned pushes = atomic_load(&queue->pushes);
+    int popped = queueTryPop(queue, block);
+    if (!popped) {
+        // returns at once if a push has bumped `pushes` since it was read
+        syscall(SYS_futex, &queue->pushes, FUTEX_WAIT_PRIVATE, pushes, timeout, NULL, 0);
+        popped = queueTryPop(queue, block);
+    }
+    atomic_store_explicit(&queue->parked, 0, memory_order_relaxed);
+    return popped;
+}
+
+static block_t* queuePop(spscQueue_t* queue) {
+    block_t* block;
+    while (!queueWaitPop(queue, &block, NULL));
+    return block;
+}
+
+// reads until `size` bytes or end of input; returns the bytes read, or -1 on an error
+static ssize_t readFully(int fd, uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = read(fd, buffer + done, size - done);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return -1;
+        if (got == 0) break;
+        done += got;
+    }
+    return done;
+}
+
+static int writeFully(int fd, const char* buffer, size_t size) {
+    while (size) {
+        ssize_t put = write(fd, buffer, size);
+        if (put < 0 && errno == EINTR) continue;
+        if (put < 0) return -1;
+        buffer += put;
+        size -= put;
+    }
+    return 0;
+}
+
+static void* readerMain(void* argument) {
+    stream_t* stream = argument;
+    size_t sequence = 0;
+
+    for (;;) {
+        block_t* block = queuePop(&stream->freeBlocks);
+        ssize_t got = readFully(STDIN_FILENO, block->input, stream->blockBytes);
+        if (got < 0) {
+            perror("stream: read");
+            atomic_store(&stream->failed, 1);
+            break;
+        }
+        stream->bytesRead += got;
+        // a short read only happens at the end of the input, so this is the last block
+        block->count = got / stream->width;
+        if (got % stream->width) {
+            fprintf(stderr, "stream: ignoring %zu trailing bytes\n", (size_t)(got % stream->width));
+            atomic_store(&stream->failed, 1);
+        }
+        if (!block->count) break;
+        queuePush(&stream->toConverter[sequence++ % stream->workers], block);
+        if ((size_t)got < stream->blockBytes) break;
+    }
+    for (int i = 0; i < stream->workers; i++) queuePush(&stream->toConverter[(sequence + i) % stream->workers], NULL);
+    return NULL;
+}
+
+static void convertBlock(const stream_t* stream, block_t* block) {
+    char* bufferPtr = block->text;
+    if (stream->width == 4) {
+        const uint8_t* in = block->input;
+        for (size_t i = 0; i < block->count; i++, in += 4) {
+            uint32_t value;
+            memcpy(&value, in, 4);
+            if (stream->isSigned && (int32_t)value < 0) {
+                *bufferPtr++ = '-';
+                value = 0 - value;
+            }
+            bufferPtr += fillBuffer(uitodec(value), bufferPtr);
+            *bufferPtr++ = '\n';
+        }
+    } else {
+        const uint8_t* in = block->input;
+        for (size_t i = 0; i < block->count; i++, in += 8) {
+            uint64_t value;
+            memcpy(&value, in, 8);
+            if (stream->isSigned && (int64_t)value < 0) {
+                *bufferPtr++ = '-';
+                value = 0 - value;
+            }
+            bufferPtr += fillBuffer64(uitodec64(value), bufferPtr);
+            *bufferPtr++ = '\n';
+        }
+    }
+    block->length = bufferPtr - block->text;
+}
+
+typedef struct {
+    stream_t* stream;
+    int index;
+} converter_t;
+
+static void* converterMain(void* argument) {
+    converter_t* converter = argument;
+    stream_t* stream = converter->stream;
+    for (;;) {
+        block_t* block = queuePop(&stream->toConverter[converter->index]);
+        if (block) convertBlock(stream, block);
+        queuePush(&stream->toWriter[converter->index], block);
+        if (!block) return NULL;
+    }
+}
+
+// asyncwrite.c hands each block back here, on the writer thread, once its text is on disk or its write failed
+static void recycleBlock(void* context, void* tag, int error) {
+    stream_t* stream = context;
+    block_t* block = tag;
+    if (!error) stream->bytesWritten += block->length;
+    queuePush(&stream->freeBlocks, block);
+}
+
+static void* fileWriterMain(void* argument) {
+    stream_t* stream = argument;
+    asyncWriter_t* writer = asyncwriter_open(stream->outputPath, stream->writeDepth, stream->writeFlags, recycleBlock, stream);
+    int writeFailed = !writer;
+
+    if (!writer) {
+        perror("stream: open");
+        atomic_store(&stream->failed, 1);
+    }
+    for (size_t sequence = 0;; sequence++) {
+        // finished writes have to be collected while waiting, or their blocks never get back to the reader,
+        // so the writer only sleeps for good once nothing is in flight
+        static const struct timespec pollInterval = {.tv_nsec = 200000};
+        block_t* block;
+        while (!queueWaitPop(&stream->toWriter[sequence % stream->workers], &block,
+                             writer && asyncwriter_poll(writer) ? &pollInterval : NULL));
+        if (!block) break;
+        if (writeFailed) {
+            queuePush(&stream->freeBlocks, block);
+        } else if (asyncwriter_submit(writer, block->text, block->length, block) < 0) {
+            perror("stream: write");
+            writeFailed = 1;
+            atomic_store(&stream->failed, 1);
+        }
+    }
+    if (writer && asyncwriter_close(writer, &stream->writeStats) < 0 && !writeFailed) {
+        perror("stream: write");
+        atomic_store(&stream->failed, 1);
+    }
+    return NULL;
+}
+
+static void* writerMain(void* argument) {
+    stream_t* stream = argument;
+    int writeFailed = 0;
+    for (size_t sequence = 0;; sequence++) {
+        block_t* block = queuePop(&stream->toWriter[sequence % stream->workers]);
+        if (!block) return NULL;
+        if (!writeFailed && writeFully(STDOUT_FILENO, block->text, block->length) < 0) {
+            perror("stream: write");
+            writeFailed = 1; // keep draining so the other stages can finish
+            atomic_store(&stream->failed, 1);
+        }
+        if (!writeFailed) stream->bytesWritten += block->length;
+        queuePush(&stream->freeBlocks, block);
+    }
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+    stream_t stream = {.width = 4, .blockBytes = 1 << 20};
+    int workers = sysconf(_SC_NPROCESSORS_ONLN) - 2;
+    int depth = 4, quiet = 0, opt;
+
+    stream.writeDepth = 3;
+    while ((opt = getopt(argc, argv, "w:sj:b:d:o:u:Pq")) != -1) {
+        switch (opt) {
+        case 'w': stream.width = atoi(optarg); break;
+        case 's': stream.isSigned = 1; break;
+        case 'j': workers = atoi(optarg); break;
+        case 'b': stream.blockBytes = (size_t)strtoull(optarg, NULL, 0) << 10; break;
+        case 'd': depth = atoi(optarg); break;
+        case 'o': stream.outputPath = optarg; break;
+        case 'u': stream.writeDepth = atoi(optarg); break;
+        case 'P': stream.writeFlags |= TP_WRITER_PWRITE; break;
+        case 'q': quiet = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-w 4|8] [-s] [-j workers] [-b block KiB] [-d depth] [-o file [-u writes] [-P]] [-q]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (stream.width != 4 && stream.width != 8) {
+        fprintf(stderr, "stream: width must be 4 or 8\n");
+        return 2;
+    }
+    if (workers < 1) workers = 1;
+    if (depth < 2) depth = 2;
+    stream.blockBytes -= stream.blockBytes % stream.width;
+    if (stream.blockBytes < (size_t)stream.width) stream.blockBytes = stream.width;
+    stream.workers = workers;
+
+    // the longest line per integer: 10 or 20 digits, a sign and the newline
+    size_t textBytes = stream.blockBytes / stream.width * (stream.width == 4 ? 12 : 22);
+    int blockCount = workers * depth;
+    block_t* blocks = calloc(blockCount, sizeof(block_t));
+    converter_t* converters = calloc(workers, sizeof(converter_t));
+    pthread_t* converterThreads = calloc(workers, sizeof(pthread_t));
+    pthread_t reader, writer;
+
+    queueInit(&stream.freeBlocks, blockCount);
+    stream.toConverter = calloc(workers, sizeof(spscQueue_t));
+    stream.toWriter = calloc(workers, sizeof(spscQueue_t));
+    for (int i = 0; i < workers; i++) {
+        // each ring also has room for the closing NULL
+        queueInit(&stream.toConverter[i], blockCount + 1);
+        queueInit(&stream.toWriter[i], blockCount + 1);
+    }
+    for (int i = 0; i < blockCount; i++) {
+        blocks[i].input = malloc(stream.blockBytes);
+        blocks[i].text = malloc(textBytes);
+        if (!blocks[i].input || !blocks[i].text) {
+            fprintf(stderr, "stream: out of memory\n");
+            return 1;
+        }
+        queuePush(&stream.freeBlocks, &blocks[i]);
+    }
+
+    double start = now();
+    pthread_create(&reader, NULL, readerMain, &stream);
+    for (int i = 0; i < workers; i++) {
+        converters[i] = (converter_t){.stream = &stream, .index = i};
+        pthread_create(&converterThreads[i], NULL, converterMain, &converters[i]);
+    }
+    pthread_create(&writer, NULL, stream.outputPath ? fileWriterMain : writerMain, &stream);
+    pthread_join(reader, NULL);
+    for (int i = 0; i < workers; i++) pthread_join(converterThreads[i], NULL);
+    pthread_join(writer, NULL);
+    double elapsed = now() - start;
+
+    if (!quiet) {
+        uint64_t values = stream.bytesRead / stream.width;
+        fprintf(stderr, "stream: %llu integers, %.1f MB in, %.1f MB out in %.3f s: %.1f M integers/s, %.1f MB/s out"
+                        " (%d converters, %d blocks of %zu KiB in flight)\n",
+                (unsigned long long)values, stream.bytesRead / 1e6, stream.bytesWritten / 1e6, elapsed,
+                values / elapsed / 1e6, stream.bytesWritten / elapsed / 1e6, workers, blockCount, stream.blockBytes >> 10);
+        if (stream.outputPath && stream.writeStats.backend) {
+            fprintf(stderr, "stream: %s, %llu writes, busy %.3f s, writer stalled %.3f s, overlap efficiency %.0f%%\n",
+                    stream.writeStats.backend, (unsigned long long)stream.writeStats.writes, stream.writeStats.busySeconds,
+                    stream.writeStats.stalledSeconds, stream.writeStats.overlap * 100);
+        }
+    }
+    for (int i = 0; i < blockCount; i++) {
+        free(blocks[i].input);
+        free(blocks[i].text);
+    }
+    for (int i = 0; i < workers; i++) {
+        free(stream.toConverter[i].slots);
+        free(stream.toWriter[i].slots);
+    }
+    free(stream.freeBlocks.slots);
+    free(stream.toConverter);
+    free(stream.toWriter);
+    free(converters);
+    free(converterThreads);
+    free(blocks);
+    return atomic_load(&stream.failed);
+}
@@ -0,0 +1,181 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "toothpaste.h"
+
+/*
+ * A bump-allocated pool of converted integers.
+ *
+ * Values are converted straight into the current chunk of the arena, and the caller gets back a view
+ * {ptr, len} of the text (which is also NUL-terminated). When a chunk fills up the pool moves on to the next one,
+ * allocating it only the first time: strpool_reset just rewinds to the first chunk, so a pool that is reset
+ * and refilled every batch stops allocating after the first round.
+ *
+ * With TP_POOL_INTERN, a value that was already converted since the last reset returns the earlier view.
+ * The intern table is open-addressed on the value. Each slot records the generation it was written in, and a reset
+ * bumps the generation, which empties the table without touching it. If the table can't grow, values that
+ * don't fit are still converted, just not interned.
+ */
+
+#define chunkHeadroom 21 // the longest conversion, 64-bit with its terminator
+
+typedef struct chunk {
+    struct chunk* next;
+    size_t size;
+    char data[];
+} chunk_t;
+
+typedef struct {
+    uint64_t value;
+    uint32_t generation;
+    stringView_t view;
+} internSlot_t;
+
+struct stringPool {
+    chunk_t* first;
+    chunk_t* current;
+    size_t used;
+    size_t chunkSize;
+    int flags;
+    uint32_t generation;
+    internSlot_t* slots;
+    size_t slotMask;
+    size_t interned;
+};
+
+static chunk_t* newChunk(size_t size) {
+    chunk_t* created = malloc(sizeof(chunk_t) + size);
+    if (!created) return NULL;
+    created->next = NULL;
+    created->size = size;
+    return created;
+}
+
+stringPool_t* strpool_create(size_t chunkSize, int flags) {
+    stringPool_t* pool = calloc(1, sizeof(stringPool_t));
+    if (!pool) return NULL;
+    if (chunkSize < chunkHeadroom) chunkSize = 64 * 1024;
+    pool->chunkSize = chunkSize;
+    pool->flags = flags;
+    pool->generation = 1;
+    pool->first = pool->current = newChunk(chunkSize);
+    if (!pool->first) {
+        free(pool);
+        return NULL;
+    }
+    if (flags & TP_POOL_INTERN) {
+        pool->slots = calloc(1024, sizeof(internSlot_t));
+        if (!pool->slots) {
+            free(pool->first);
+            free(pool);
+            return NULL;
+        }
+        pool->slotMask = 1023;
+    }
+    return pool;
+}
+
+void strpool_reset(stringPool_t* pool) {
+    pool->current = pool->first;
+    pool->used = 0;
+    pool->interned = 0;
+    if (++pool->generation == 0) {
+        // wrapped around: slots from 2^32 resets ago would look current again
+        if (pool->slots) memset(pool->slots, 0, (pool->slotMask + 1) * sizeof(internSlot_t));
+        pool->generation = 1;
+    }
+}
+
+void strpool_destroy(stringPool_t* pool) {
+    chunk_t* next;
+    if (!pool) return;
+    for (chunk_t* c = pool->first; c; c = next) {
+        next = c->next;
+        free(c);
+    }
+    free(pool->slots);
+    free(pool);
+}
+
+size_t strpool_bytes_used(const stringPool_t* pool) {
+    size_t bytes = pool->used;
+    for (const chunk_t* c = pool->first; c != pool->current; c = c->next) bytes += c->size;
+    return bytes;
+}
+
+// room for one more conversion, moving to (or allocating) the next chunk if needed
+static char* reserve(stringPool_t* pool) {
+    if (pool->current->size - pool->used < chunkHeadroom) {
+        if (!pool->current->next) {
+            pool->current->next = newChunk(pool->chunkSize);
+            if (!pool->current->next) return NULL;
+        }
+        pool->current = pool->current->next;
+        pool->used = 0;
+    }
+    return pool->current->data + pool->used;
+}
+
+static size_t slotFor(const stringPool_t* pool, uint64_t value) {
+    // Fibonacci hashing: consecutive values spread across the table
+    return (size_t)((value * 0x9e3779b97f4a7c15ull) >> 32) & pool->slotMask;
+}
+
+static internSlot_t* findSlot(stringPool_t* pool, uint64_t value) {
+    size_t slot = slotFor(pool, value);
+    while (pool->slots[slot].generation == pool->generation && pool->slots[slot].value != value) {
+        slot = (slot + 1) & pool->slotMask;
+    }
+    return &pool->slots[slot];
+}
+
+// doubles the table, keeping only this generation's entries; on failure the table keeps filling until convert stops interning
+static void growSlots(stringPool_t* pool) {
+    internSlot_t* old = pool->slots;
+    size_t oldCount = pool->slotMask + 1;
+    internSlot_t* grown = calloc(oldCount * 2, sizeof(internSlot_t));
+    if (!grown) return;
+    pool->slots = grown;
+    pool->slotMask = oldCount * 2 - 1;
+    for (size_t i = 0; i < oldCount; i++) {
+        if (old[i].generation == pool->generation) *findSlot(pool, old[i].value) = old[i];
+    }
+    free(old);
+}
+
+static stringView_t convert(stringPool_t* pool, uint64_t value, int wide) {
+    stringView_t view = {NULL, 0};
+    internSlot_t* slot = NULL;
+    char* text;
+
+    if (pool->flags & TP_POOL_INTERN) {
+        if (pool->interned * 2 >= pool->slotMask) growSlots(pool);
+        slot = findSlot(pool, value);
+        if (slot->generation == pool->generation) return slot->view;
+        // growth failed and only the empty slot that ends every probe is left: convert without interning
+        if (pool->interned >= pool->slotMask) slot = NULL;
+    }
+
+    text = reserve(pool);
+    if (!text) return view;
+    view.ptr = text;
+    view.len = wide ? fillBuffer64(uitodec64(value), text) : fillBuffer(uitodec((uint32_t)value), text);
+    pool->used += view.len + 1;
+
+    if (slot) {
+        slot->value = value;
+        slot->generation = pool->generation;
+        slot->view = view;
+        pool->interned++;
+    }
+    return view;
+}
+
+stringView_t strpool_u32(stringPool_t* pool, uint32_t value) {
+    return convert(pool, value, 0);
+}
+
+stringView_t strpool_u64(stringPool_t* pool, uint64_t value) {
+    return convert(pool, value, 1);
+}
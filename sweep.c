@@ -0,0 +1,395 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "toothpaste.h"
+#include "toothpaste_inline.h"
+
+/*
+ * Exhaustive sweep: every 32-bit input through every engine, on every core, checked against a reference.
+ * Build: cc -O2 sweep.c toothpaste.c radix.c engines.c adaptive.c fixed.c ipv4.c -pthread -lm -o sweep
+ * Usage: sweep [-b begin] [-n count] [-w window] [engine ...]   (defaults: all 2^32 inputs, all engines)
+ *
+ * The reference doesn't share code with any engine: each thread writes its first input out by division, in the
+ * engine's base, and increments that text in place from there, which is cheap enough that the engines dominate
+ * the run time. The fixed-point engines get the point placed into it by hand, and format_ipv4 is checked
+ * against the text of each octet.
+ * The reported rate is inputs per second across all threads for that engine alone, i.e. the sustained
+ * full-range throughput of the machine.
+ *
+ * The wide engines can't be swept exhaustively. The 8-bit one is (all 256 inputs); the 64-bit ones, uitodec64
+ * and uitoa_fixed64, run every input within `window` (default 2^16) of 0, of each 2^k from 2^32 up to 2^63, of
+ * each 10^k from 10^10 up to 10^19, and of the top of the range, which covers every change of digit count and
+ * every bit a carry can run into. -b and -n only apply to the 32-bit engines.
+ *
+ * toothpaste::to_chars isn't here because it is C++. It picks uitodec or uitodec64 by the width of T, and both
+ * are swept; what it adds (the sign and the value_too_large check) is only run by bench's tp::to_chars row.
+ */
+
+static int uitoaToothpaste(uint32_t i, char* a) {
+    return fillBuffer(uitodec(i), a);
+}
+
+static int uitoaConstantTime(uint32_t i, char* a) {
+    return fillBuffer_ct(uitodec_ct(i), a);
+}
+
+static int uitoaVia64(uint32_t i, char* a) {
+    return fillBuffer64(uitodec64(i), a);
+}
+
+static int uitoaInline(uint32_t i, char* a) {
+    return uitoa_inline(i, a);
+}
+
+static int uitoaFixedScale4(uint32_t i, char* a) {
+    return uitoa_fixed(i, 4, 0, a);
+}
+
+static int uitoaFixedScale12(uint32_t i, char* a) {
+    return uitoa_fixed(i, 12, 0, a);
+}
+
+static const struct {
+    const char* name;
+    int (*convert)(uint32_t, char*);
+    int base;   // of the reference text
+    int scale;  // places after the point the fixed-point engines put into the reference
+    int dotted; // the reference is the input as a dotted quad
+} engines[] = {
+    {"toothpaste", uitoaToothpaste, 10, 0, 0},
+    {"inline", uitoaInline, 10, 0, 0},
+    {"toothpaste64", uitoaVia64, 10, 0, 0},
+    {"consttime", uitoaConstantTime, 10, 0, 0},
+    {"radix10", uitoa_radix10, 10, 0, 0},
+    {"radix2", uitoa_radix2, 2, 0, 0},
+    {"radix8", uitoa_radix8, 8, 0, 0},
+    {"radix16", uitoa_radix16, 16, 0, 0},
+    {"radix36", uitoa_radix36, 36, 0, 0},
+    {"setbits", uitoa_setbits, 10, 0, 0},
+    {"byterom", uitoa_byterom, 10, 0, 0},
+    {"pairs", uitoa_pairs, 10, 0, 0},
+    {"adaptive", uitoa_adaptive, 10, 0, 0},
+    {"fixed", uitoaFixedScale4, 10, 4, 0},
+    {"fixeds12", uitoaFixedScale12, 10, 12, 0},
+    {"ipv4", format_ipv4, 10, 0, 1},
+};
+
+static const int engineCount = sizeof(engines) / sizeof(engines[0]);
+
+static int uitoaWide64(uint64_t i, char* a) {
+    return fillBuffer64(uitodec64(i), a);
+}
+
+static int uitoaFixed64Scale2(uint64_t i, char* a) {
+    return uitoa_fixed64(i, 2, 0, a);
+}
+
+static int uitoaFixed64Scale21(uint64_t i, char* a) {
+    return uitoa_fixed64(i, 21, 0, a);
+}
+
+static int uitoaWide8(uint64_t i, char* a) {
+    return fillBuffer8(uitodec8((uint8_t)i), a);
+}
+
+static const struct {
+    const char* name;
+    int (*convert)(uint64_t, char*);
+    int bits;  // 8: swept exhaustively, 64: swept in windows
+    int scale; // places after the point the fixed-point engines put into the reference
+} wideEngines[] = {
+    {"uitodec64", uitoaWide64, 64, 0},
+    {"fixed64", uitoaFixed64Scale2, 64, 2},
+    {"fixed64s21", uitoaFixed64Scale21, 64, 21},
+    {"toothpaste8", uitoaWide8, 8, 0},
+};
+
+static const int wideEngineCount = sizeof(wideEngines) / sizeof(wideEngines[0]);
+
+typedef struct {
+    int engine;
+    int wide; // `engine` indexes wideEngines
+    uint64_t begin;
+    uint64_t count; // a count rather than an end, since a window can reach 2^64
+    uint64_t mismatches;
+    uint64_t firstMismatch;
+} sweepTask_t;
+
+static const char alphabet[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// `value` written out in `base` by repeated division
+static int referenceText(uint64_t value, int base, char* reference) {
+    char reversed[64];
+    int length = 0;
+    do {
+        reversed[length++] = alphabet[value % base];
+        value /= base;
+    } while (value);
+    for (int i = 0; i < length; i++) reference[i] = reversed[length - 1 - i];
+    reference[length] = '\0';
+    return length;
+}
+
+// the reference text of value + 1
+static void increment(char* reference, int* length, int base) {
+    int digit = *length - 1;
+    while (digit >= 0 && reference[digit] == alphabet[base - 1]) reference[digit--] = '0';
+    if (digit >= 0) {
+        reference[digit] = reference[digit] == '9' ? 'a' : reference[digit] + 1;
+    } else {
+        memmove(reference + 1, reference, *length + 1);
+        reference[0] = '1';
+        (*length)++;
+    }
+}
+
+// what uitoa_fixed and uitoa_fixed64 should write for the integer text `reference` with `scale` (at least 1) places after the point
+static int placePoint(const char* reference, int length, int scale, char* expected) {
+    char* bufferPtr = expected;
+    int integerPlaces = length > scale ? length - scale : 0;
+    if (integerPlaces) {
+        memcpy(bufferPtr, reference, integerPlaces);
+        bufferPtr += integerPlaces;
+    } else {
+        *bufferPtr++ = '0';
+    }
+    *bufferPtr++ = '.';
+    for (int i = length; i < scale; i++) *bufferPtr++ = '0';
+    memcpy(bufferPtr, reference + integerPlaces, length - integerPlaces + 1);
+    return bufferPtr - expected + length - integerPlaces;
+}
+
+static void mismatch(sweepTask_t* task, uint64_t value) {
+    if (!task->mismatches) task->firstMismatch = value;
+    task->mismatches++;
+}
+
+// format_ipv4 against the first three octets, rewritten every 256 inputs, and a table of every last octet
+static void sweepDottedQuads(sweepTask_t* task) {
+    char octets[256][4], prefix[16], buffer[16];
+    int octetLengths[256], prefixLength = 0;
+    uint64_t value = task->begin;
+
+    for (int octet = 0; octet < 256; octet++) octetLengths[octet] = referenceText(octet, 10, octets[octet]);
+    for (uint64_t n = 0; n < task->count; n++, value++) {
+        int last = value & 255;
+        if (!n || !last) {
+            prefixLength = 0;
+            for (int shift = 24; shift > 0; shift -= 8) {
+                prefixLength += referenceText((value >> shift) & 255, 10, prefix + prefixLength);
+                prefix[prefixLength++] = '.';
+            }
+        }
+        int converted = engines[task->engine].convert((uint32_t)value, buffer);
+        if (converted != prefixLength + octetLengths[last] || memcmp(buffer, prefix, prefixLength)
+            || memcmp(buffer + prefixLength, octets[last], octetLengths[last] + 1)) {
+            mismatch(task, value);
+        }
+    }
+}
+
+static void* sweepRange(void* argument) {
+    sweepTask_t* task = argument;
+    char reference[40], buffer[48], expected[48];
+    uint64_t value = task->begin;
+    int length;
+
+    if (!task->wide) {
+        int (*convert)(uint32_t, char*) = engines[task->engine].convert;
+        int base = engines[task->engine].base;
+        int scale = engines[task->engine].scale;
+        if (engines[task->engine].dotted) {
+            sweepDottedQuads(task);
+            return NULL;
+        }
+        length = referenceText(value, base, reference);
+        for (uint64_t n = 0; n < task->count; n++, value++) {
+            int converted = convert((uint32_t)value, buffer);
+            const char* want = reference;
+            int wantLength = length;
+            if (scale) {
+                wantLength = placePoint(reference, length, scale, expected);
+                want = expected;
+            }
+            if (converted != wantLength || memcmp(buffer, want, wantLength + 1)) mismatch(task, value);
+            increment(reference, &length, base);
+        }
+    } else {
+        length = referenceText(value, 10, reference);
+        int (*convert)(uint64_t, char*) = wideEngines[task->engine].convert;
+        int scale = wideEngines[task->engine].scale;
+        for (uint64_t n = 0; n < task->count; n++, value++) {
+            int converted = convert(value, buffer);
+            const char* want = reference;
+            int wantLength = length;
+            if (scale) {
+                wantLength = placePoint(reference, length, scale, expected);
+                want = expected;
+            }
+            if (converted != wantLength || memcmp(buffer, want, wantLength + 1)) mismatch(task, value);
+            increment(reference, &length, 10);
+        }
+    }
+    return NULL;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    uint64_t mismatches;
+    uint64_t firstMismatch;
+} sweepResult_t;
+
+// splits [begin, begin + count) across the threads and adds what they find to `result`
+static void sweepSpan(int engine, int wide, uint64_t begin, uint64_t count, int threads, sweepResult_t* result) {
+    pthread_t* workers = malloc(threads * sizeof(pthread_t));
+    sweepTask_t* tasks = malloc(threads * sizeof(sweepTask_t));
+
+    uint64_t share = count / threads, extra = count % threads; // the first `extra` threads take one more
+
+    for (int t = 0; t < threads; t++) {
+        uint64_t index = t;
+        tasks[t] = (sweepTask_t){
+            .engine = engine,
+            .wide = wide,
+            .begin = begin + share * index + (index < extra ? index : extra),
+            .count = share + (index < extra),
+        };
+        pthread_create(&workers[t], NULL, sweepRange, &tasks[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+        if (tasks[t].mismatches && (!result->mismatches || tasks[t].firstMismatch < result->firstMismatch)) {
+            result->firstMismatch = tasks[t].firstMismatch;
+        }
+        result->mismatches += tasks[t].mismatches;
+    }
+    free(workers);
+    free(tasks);
+}
+
+static void report(const char* name, uint64_t count, double elapsed, const sweepResult_t* result) {
+    printf("%-13s %12llu inputs %8.2f s %8.1f M/s", name, (unsigned long long)count, elapsed, count / elapsed / 1e6);
+    if (result->mismatches) {
+        printf("  %llu MISMATCHES, first at %llu\n", (unsigned long long)result->mismatches, (unsigned long long)result->firstMismatch);
+    } else {
+        printf("  ok\n");
+    }
+}
+
+static void sweepEngine(int engine, uint64_t begin, uint64_t count, int threads) {
+    sweepResult_t result = {0, 0};
+    double start = now();
+    sweepSpan(engine, 0, begin, count, threads, &result);
+    report(engines[engine].name, count, now() - start, &result);
+}
+
+typedef struct {
+    uint64_t first;
+    uint64_t last; // inclusive, so the top window can end at UINT64_MAX
+} window_t;
+
+static int compareWindows(const void* a, const void* b) {
+    const window_t* left = a;
+    const window_t* right = b;
+    return left->first < right->first ? -1 : left->first > right->first;
+}
+
+// the windows around every interesting 64-bit value, sorted with overlaps merged; returns how many there are
+static int buildWindows(uint64_t radius, window_t windows[64]) {
+    uint64_t centers[64];
+    int centerCount = 0, windowCount = 0;
+
+    centers[centerCount++] = 0;
+    for (int k = 32; k < 64; k++) centers[centerCount++] = 1ull << k;
+    for (uint64_t power = 10000000000ull;; power *= 10) {
+        centers[centerCount++] = power;
+        if (power > UINT64_MAX / 10) break;
+    }
+    centers[centerCount++] = UINT64_MAX; // stands in for 2^64, whose window is all below it
+    for (int c = 0; c < centerCount; c++) {
+        uint64_t center = centers[c];
+        windows[c].first = center > radius ? center - radius : 0;
+        windows[c].last = center > UINT64_MAX - radius ? UINT64_MAX : center + radius;
+    }
+    qsort(windows, centerCount, sizeof(window_t), compareWindows);
+    for (int c = 0; c < centerCount; c++) {
+        if (windowCount && windows[c].first <= windows[windowCount-1].last + 1) {
+            if (windows[c].last > windows[windowCount-1].last) windows[windowCount-1].last = windows[c].last;
+        } else {
+            windows[windowCount++] = windows[c];
+        }
+    }
+    return windowCount;
+}
+
+static void sweepWideEngine(int engine, uint64_t radius, int threads) {
+    sweepResult_t result = {0, 0};
+    uint64_t count = 0;
+    double start = now();
+
+    if (wideEngines[engine].bits == 8) {
+        count = 256;
+        sweepSpan(engine, 1, 0, count, 1, &result);
+    } else {
+        window_t windows[64];
+        int windowCount = buildWindows(radius, windows);
+        for (int w = 0; w < windowCount; w++) {
+            uint64_t size = windows[w].last - windows[w].first + 1;
+            sweepSpan(engine, 1, windows[w].first, size, threads, &result);
+            count += size;
+        }
+    }
+    report(wideEngines[engine].name, count, now() - start, &result);
+}
+
+int main(int argc, char** argv) {
+    uint64_t begin = 0, count = 1ull << 32, window = 1 << 16;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt, selected = 0;
+
+    while ((opt = getopt(argc, argv, "b:n:w:")) != -1) {
+        switch (opt) {
+        case 'b': begin = strtoull(optarg, NULL, 0); break;
+        case 'n': count = strtoull(optarg, NULL, 0); break;
+        case 'w': window = strtoull(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-b begin] [-n count] [-w window] [engine ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (begin > 1ull << 32) begin = 1ull << 32;
+    if (count > (1ull << 32) - begin) count = (1ull << 32) - begin;
+    if (threads < 1) threads = 1;
+    if (window > 1ull << 40) window = 1ull << 40;
+
+    printf("sweeping [%llu, %llu) on %d threads\n", (unsigned long long)begin, (unsigned long long)(begin + count), threads);
+    for (int engine = 0; engine < engineCount; engine++) {
+        int wanted = optind == argc;
+        for (int arg = optind; arg < argc; arg++) wanted |= !strcmp(argv[arg], engines[engine].name);
+        if (!wanted) continue;
+        sweepEngine(engine, begin, count, threads);
+        selected++;
+    }
+    for (int engine = 0; engine < wideEngineCount; engine++) {
+        int wanted = optind == argc;
+        for (int arg = optind; arg < argc; arg++) wanted |= !strcmp(argv[arg], wideEngines[engine].name);
+        if (!wanted) continue;
+        sweepWideEngine(engine, window, threads);
+        selected++;
+    }
+    if (!selected) {
+        fprintf(stderr, "no such engine\n");
+        return 2;
+    }
+    return 0;
+}
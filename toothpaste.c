@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "toothpaste.h"
+#include "toothpaste_core.h"
+
+/*
+ * ROM-based integer to string conversion
+ * (a.k.a. "toothpaste itoa")
+ *
+ * This algorithm converts a 32-bit integer to a zero-padded decimal string using a ROM lookup method.
+ * It relies on the `fullDecimal32_t` union described below, which provides an accumulator (as a struct)
+ * for adding decimal digits efficiently.
+ *
+ * For each bit set to 1 in the input integer, the corresponding precomputed decimal representation
+ * (a byte-per-digit array) is fetched from ROM and added to the accumulator.
+ * For example, bit 5 (value 32) corresponds to: {0, 0, 0, 0, 0, 0, 0, 0, 3, 2} — normalized to 0–9 digits (not ASCII).
+ *
+ * The addition is optimized: each decimal array is treated as two integers, allowing the full array
+ * to be added in just two steps.
+ *
+ * Crucially, in 32-bit integers, each decimal digit stays within its 8-bit slot during addition —
+ * no intermediate carries are needed. This makes it safe to delay carry propagation until the end.
+ * The final carry is applied from right to left — like squeezing a tube of toothpaste.
+ * Carry is optimized to use no division by employing quotient and remainder ROMs. This is relatively cheap because the dividend can only be one of 256 values.
+ *
+ * This doesn’t hold for 64-bit integers — overflow may occur during intermediate steps.
+ * To adapt this algorithm for 64-bit integers, consider:
+ *   - Applying carry propagation periodically (e.g., every 25 adds — worst case if all addends were 999 ... 999),
+ *   - Using 16-bit slots per digit to make overflow a non-concern, or
+ *   - Monitoring the accumulator to perform carries only when needed.
+ * `uitodec64` takes the first route with a period of 32: it accumulates the upper half, squeezes once, then
+ * accumulates the lower half. The worst slot reaches 215 in the upper half and 155 + 9 in the lower half.
+ *
+ * toothpaste_inline.h carries a header-only copy of the 32-bit engine for callers that want it inlined or folded;
+ * the ROMs and the carry tables are written out once, in toothpaste_tables.h, for both and for toothpaste.hpp.
+ *
+ *  It's not actually very fast. I expected it to be, since it saves divisions, which are rumored to be slow. However, typical approaches beat it out by a factor of ~3-5.
+ *  Its order should be, for a bitwidth n, O(n + log10(2^n)), approximately linear and slightly better than 2n:
+ *   - n work for accumulating the decimal places
+ *   - log10(2^n) (or the number of decimal places) for carrying from right to left
+ */
+
+/*
+ * Per-stage statistics, compiled in with -DTOOTHPASTE_STATS and gone entirely without it.
+ * Counters are thread-local, so recording is a few unshared increments plus an unserialized rdtsc per stage
+ * boundary; readers only ever see their own thread's numbers.
+ */
+
+#ifdef TOOTHPASTE_STATS
+static _Thread_local toothpasteStats_t stats;
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t statsTicks(void) {
+    return __rdtsc();
+}
+#else
+static inline uint64_t statsTicks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+#define STATS_BEGIN(since) uint64_t since = statsTicks()
+#define STATS_STAGE(stage, since) do { \
+        uint64_t now = statsTicks(); \
+        stats.calls[stage]++; \
+        stats.ticks[stage] += now - since; \
+        since = now; \
+    } while (0)
+#define STATS_COUNT(histogram, index) (stats.histogram[index]++)
+#else
+#define STATS_BEGIN(since)
+#define STATS_STAGE(stage, since)
+#define STATS_COUNT(histogram, index)
+#endif
+
+void tp_stats_get(toothpasteStats_t* out) {
+#ifdef TOOTHPASTE_STATS
+    *out = stats;
+#else
+    memset(out, 0, sizeof(*out));
+#endif
+}
+
+void tp_stats_reset(void) {
+#ifdef TOOTHPASTE_STATS
+    memset(&stats, 0, sizeof(stats));
+#endif
+}
+
+void tp_stats_dump(void) {
+    static const char* stageNames[] = {"accumulate", "squeeze", "fill"};
+    toothpasteStats_t snapshot;
+    tp_stats_get(&snapshot);
+    for (int stage = 0; stage < 3; stage++) {
+        fprintf(stderr, "%-10s %12llu calls %14llu ticks %8.1f ticks/call\n", stageNames[stage],
+                (unsigned long long)snapshot.calls[stage], (unsigned long long)snapshot.ticks[stage],
+                snapshot.calls[stage] ? (double)snapshot.ticks[stage] / snapshot.calls[stage] : 0.0);
+    }
+    fprintf(stderr, "digits:");
+    for (int length = 1; length <= 10; length++) fprintf(stderr, " %d:%llu", length, (unsigned long long)snapshot.digitLengths[length]);
+    fprintf(stderr, "\nbits:");
+    for (int length = 0; length <= 32; length++) fprintf(stderr, " %d:%llu", length, (unsigned long long)snapshot.bitLengths[length]);
+    fprintf(stderr, "\n");
+}
+
+// for reference: A decimal is "happy" when none of its bytes has value > 9
+
+const uint8_t quotients[] = TOOTHPASTE_QUOTIENTS_INIT;
+const uint8_t remainders[] = TOOTHPASTE_REMAINDERS_INIT;
+
+int fillBuffer(fullDecimal32_t decimal, char buffer[11]) {
+    int decimalPtr = 0;
+    int bufferPtr;
+    STATS_BEGIN(since);
+
+    if (decimal.arith.low == 0 && decimal.arith.high == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        STATS_COUNT(digitLengths, 1);
+        STATS_STAGE(TP_STAGE_FILL, since);
+        return 1;
+    }
+
+    while (decimal.digits[decimalPtr] == 0) decimalPtr++;
+    bufferPtr = 0;
+
+    while (decimalPtr < 10) {
+        buffer[bufferPtr] = decimal.digits[decimalPtr] + '0';
+        bufferPtr++;
+        decimalPtr++;
+    }
+    buffer[bufferPtr] = '\0';
+    STATS_COUNT(digitLengths, bufferPtr);
+    STATS_STAGE(TP_STAGE_FILL, since);
+    return bufferPtr;
+}
+
+const fullDecimal32_t decimalROM[] = TOOTHPASTE_DECIMAL_ROM_INIT;
+
+fullDecimal32_t uitodec(uint32_t i) {
+    fullDecimal32_t accumulator;
+    STATS_BEGIN(since);
+    STATS_COUNT(bitLengths, i ? 32 - __builtin_clz(i) : 0);
+    accumulator = accumulate32(i, decimalROM);
+    STATS_STAGE(TP_STAGE_ACCUMULATE, since);
+    squeeze32(&accumulator, quotients, remainders);
+    STATS_STAGE(TP_STAGE_SQUEEZE, since);
+    return accumulator;
+}
+
+void uitoa(uint32_t i, char* a) {
+    fullDecimal32_t decimal = uitodec(i);
+    fillBuffer(decimal, a);
+}
+
+const fullDecimal64_t decimalROM64[] = TOOTHPASTE_DECIMAL_ROM64_INIT;
+
+int fillBuffer64(fullDecimal64_t decimal, char buffer[21]) {
+    int decimalPtr = 0;
+    int bufferPtr;
+
+    if (decimal.arith.low == 0 && decimal.arith.mid == 0 && decimal.arith.high == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return 1;
+    }
+
+    while (decimal.digits[decimalPtr] == 0) decimalPtr++;
+    bufferPtr = 0;
+
+    while (decimalPtr < 20) {
+        buffer[bufferPtr] = decimal.digits[decimalPtr] + '0';
+        bufferPtr++;
+        decimalPtr++;
+    }
+    buffer[bufferPtr] = '\0';
+    return bufferPtr;
+}
+
+fullDecimal64_t uitodec64(uint64_t i) {
+    return uitodec64Tables(i, decimalROM64, quotients, remainders);
+}
+
+void uitoa64(uint64_t i, char* a) {
+    fullDecimal64_t decimal = uitodec64(i);
+    fillBuffer64(decimal, a);
+}
+
+/*
+ * 8-bit engine: test.py's default bitwidth. Three digits, eight ROM entries, and the worst-case slot is 35,
+ * so there is a lot of headroom left over; ipv4.c uses that to run four of these side by side in one register.
+ */
+
+const fullDecimal8_t decimalROM8[] = {
+    (fullDecimal8_t){ .digits = {1, 2, 8} }, // 2^7 = 128
+    (fullDecimal8_t){ .digits = {0, 6, 4} }, // 2^6 =  64
+    (fullDecimal8_t){ .digits = {0, 3, 2} }, // 2^5 =  32
+    (fullDecimal8_t){ .digits = {0, 1, 6} }, // 2^4 =  16
+    (fullDecimal8_t){ .digits = {0, 0, 8} }, // 2^3 =   8
+    (fullDecimal8_t){ .digits = {0, 0, 4} }, // 2^2 =   4
+    (fullDecimal8_t){ .digits = {0, 0, 2} }, // 2^1 =   2
+    (fullDecimal8_t){ .digits = {0, 0, 1} }  // 2^0 =   1
+};
+
+int fillBuffer8(fullDecimal8_t decimal, char buffer[4]) {
+    int decimalPtr = 0;
+    int bufferPtr = 0;
+
+    while (decimalPtr < 2 && decimal.digits[decimalPtr] == 0) decimalPtr++;
+    while (decimalPtr < 3) {
+        buffer[bufferPtr] = decimal.digits[decimalPtr] + '0';
+        bufferPtr++;
+        decimalPtr++;
+    }
+    buffer[bufferPtr] = '\0';
+    return bufferPtr;
+}
+
+fullDecimal8_t uitodec8(uint8_t i) {
+    fullDecimal8_t accumulator = {.arith = {0, 0}};
+    fullDecimal8_t addend;
+    int8_t count = 0;
+    while (i) {
+        if (i & 0x80) {
+            addend = decimalROM8[count];
+            accumulator.arith.high += addend.arith.high;
+            accumulator.arith.low += addend.arith.low;
+        }
+        count++;
+        i <<= 1;
+    }
+    for (int i = 2; i > 0; i--) {
+        accumulator.digits[i-1] += quotients[accumulator.digits[i]];
+        accumulator.digits[i] = remainders[accumulator.digits[i]];
+    }
+    return accumulator;
+}
+
+void uitoa8(uint8_t i, char* a) {
+    fullDecimal8_t decimal = uitodec8(i);
+    fillBuffer8(decimal, a);
+}
+
+/*
+ * Constant-time variant: the same work for every input, so latency is flat and nothing about the value leaks
+ * through timing.
+ *   - All 32 ROM entries are added; a bit that is clear multiplies its entry by 0 instead of skipping it.
+ *   - The squeeze divides with (x * 205) >> 11, exact for x < 1029, in place of the quotient and remainder
+ *     tables, whose lookups would be indexed by the secret digits.
+ *   - The leading zeros are stripped by shifting the text left by 8, 4, 2 and 1 places, each step selected
+ *     with a mask, and the full 11 bytes are always stored. Bytes shifted in from the right are zero and
+ *     terminate the string.
+ */
+
+fullDecimal32_t uitodec_ct(uint32_t i) {
+    fullDecimal32_t accumulator = {.arith = {0, 0}};
+    for (int count = 0; count < 32; count++) {
+        uint64_t bit = (i >> (31 - count)) & 1;
+        accumulator.arith.high += bit * decimalROM[count].arith.high;
+        accumulator.arith.low += (uint16_t)(bit * decimalROM[count].arith.low);
+    }
+    for (int i = 9; i > 0; i--) {
+        uint32_t digit = accumulator.digits[i];
+        uint32_t quotient = (digit * 205) >> 11;
+        accumulator.digits[i-1] += quotient;
+        accumulator.digits[i] = digit - quotient * 10;
+    }
+    return accumulator;
+}
+
+int fillBuffer_ct(fullDecimal32_t decimal, char buffer[11]) {
+    uint8_t text[16 + 8] = {0};
+    uint32_t seen = 0;
+    uint32_t leading = 0;
+
+    // count leading zeros, keeping the last digit so 0 prints as "0"
+    for (int decimalPtr = 0; decimalPtr < 9; decimalPtr++) {
+        seen |= decimal.digits[decimalPtr];
+        leading += (seen - 1) >> 31;
+    }
+    for (int decimalPtr = 0; decimalPtr < 10; decimalPtr++) text[decimalPtr] = decimal.digits[decimalPtr] + '0';
+
+    for (uint32_t step = 8; step; step >>= 1) {
+        uint8_t take = -(uint8_t)((leading & step) != 0);
+        for (int bufferPtr = 0; bufferPtr < 16; bufferPtr++) {
+            text[bufferPtr] = (text[bufferPtr + step] & take) | (text[bufferPtr] & ~take);
+        }
+    }
+    memcpy(buffer, text, 11);
+    return 10 - leading;
+}
+
+void uitoa_ct(uint32_t i, char* a) {
+    fullDecimal32_t decimal = uitodec_ct(i);
+    fillBuffer_ct(decimal, a);
+}
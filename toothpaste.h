@@ -0,0 +1,352 @@
+#ifndef TOOTHPASTE_H
+#define TOOTHPASTE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Public interface of the toothpaste ROM engine (see toothpaste.c for how it works).
+ */
+
+typedef union {
+    uint8_t digits[10];
+    struct {
+        uint64_t high;
+        uint16_t low;
+    } arith;
+} fullDecimal32_t; // 10 bytes to encode at most the largest 32-bit number in decimal with 1 byte each.
+
+typedef union {
+    uint8_t digits[20];
+    struct {
+        uint64_t high;
+        uint64_t mid;
+        uint32_t low;
+    } arith;
+} fullDecimal64_t; // 20 bytes to encode at most the largest 64-bit number in decimal with 1 byte each.
+
+typedef union {
+    uint8_t digits[3];
+    struct {
+        uint16_t high;
+        uint8_t low;
+    } arith;
+} fullDecimal8_t; // 3 bytes to encode at most the largest 8-bit number in decimal with 1 byte each.
+
+/*
+ * The ROMs behind the engines, for modules that build their own accumulators out of them.
+ * Entry 0 is the most significant bit.
+ */
+
+extern const fullDecimal32_t decimalROM[32];
+extern const fullDecimal64_t decimalROM64[64];
+extern const fullDecimal8_t decimalROM8[8];
+extern const uint8_t quotients[256];
+extern const uint8_t remainders[256];
+
+int fillBuffer(fullDecimal32_t decimal, char buffer[11]);
+fullDecimal32_t uitodec(uint32_t i);
+void uitoa(uint32_t i, char* a);
+
+int fillBuffer64(fullDecimal64_t decimal, char buffer[21]);
+fullDecimal64_t uitodec64(uint64_t i);
+void uitoa64(uint64_t i, char* a);
+
+// constant time: no branches or table lookups that depend on the value; fillBuffer_ct always writes 11 bytes
+int fillBuffer_ct(fullDecimal32_t decimal, char buffer[11]);
+fullDecimal32_t uitodec_ct(uint32_t i);
+void uitoa_ct(uint32_t i, char* a);
+
+/*
+ * Alternative 32-bit engines (engines.c). Each returns the length written and needs an 11-byte buffer.
+ * setbits adds only the ROM entries of set bits, byterom adds four per-byte entries, pairs divides by 100.
+ */
+
+fullDecimal32_t uitodec_setbits(uint32_t i);
+int uitoa_setbits(uint32_t i, char* a);
+fullDecimal32_t uitodec_byterom(uint32_t i);
+int uitoa_byterom(uint32_t i, char* a);
+int uitoa_pairs(uint32_t i, char* a);
+
+int fillBuffer8(fullDecimal8_t decimal, char buffer[4]);
+fullDecimal8_t uitodec8(uint8_t i);
+void uitoa8(uint8_t i, char* a);
+
+/*
+ * Per-stage counters for uitodec and fillBuffer, recorded only when toothpaste.c is built with -DTOOTHPASTE_STATS
+ * (otherwise the hot path is untouched and tp_stats_get reports zeros). Counters are per thread: tp_stats_get and
+ * tp_stats_reset act on the calling thread's, and tp_stats_dump prints them to stderr.
+ * `ticks` are TSC cycles on x86 and nanoseconds elsewhere.
+ */
+
+#define TP_STAGE_ACCUMULATE 0
+#define TP_STAGE_SQUEEZE 1
+#define TP_STAGE_FILL 2
+
+typedef struct {
+    uint64_t calls[3];
+    uint64_t ticks[3];
+    uint64_t digitLengths[11]; // indexed by output length, 1-10
+    uint64_t bitLengths[33];   // indexed by the position of the highest set bit, 0 for zero
+} toothpasteStats_t;
+
+void tp_stats_get(toothpasteStats_t* out);
+void tp_stats_reset(void);
+void tp_stats_dump(void);
+
+/*
+ * Adaptive engine selection (adaptive.c). uitoa_adaptive samples the bit length and popcount of what each thread
+ * converts and periodically switches that thread to the engine the cost model rates cheapest; pass your own
+ * zero-initialized adaptiveSite_t to uitoa_adaptive_site to track a call site separately. `engine` in a site is
+ * the current choice. tp_adaptive_calibrate() re-measures the cost model on this machine; call it once at
+ * startup, before other threads convert. tp_adaptive_model reads an engine's {fixed, per bit, per set bit} costs in ns,
+ * or returns -1 if `engine` isn't one of the TP_ENGINE_ constants.
+ */
+
+#define TP_ENGINE_TOOTHPASTE 0
+#define TP_ENGINE_SETBITS 1
+#define TP_ENGINE_BYTEROM 2
+#define TP_ENGINE_PAIRS 3
+#define TP_ENGINE_COUNT 4
+
+typedef struct {
+    int engine;
+    uint32_t sinceRepick;
+    uint64_t samples;
+    uint64_t bitLengthSum;
+    uint64_t popcountSum;
+} adaptiveSite_t;
+
+int uitoa_adaptive(uint32_t i, char* a);
+int uitoa_adaptive_site(adaptiveSite_t* site, uint32_t i, char* a);
+adaptiveSite_t* tp_adaptive_thread_site(void);
+const char* tp_engine_name(int engine);
+void tp_adaptive_calibrate(void);
+int tp_adaptive_model(int engine, double coefficients[3]);
+
+/*
+ * Where the table-driven engines keep their tables, for benchmarks that evict them (bench's cold mode).
+ * Each call fills `tables` with the address and size of every table the engine reads and returns how many there
+ * are, or -1 for an engine it doesn't know. tp_engine_tables takes a TP_ENGINE_ constant (engines.c);
+ * tp_adaptive_tables covers uitoa_adaptive: its own state and the tables of every engine it can pick.
+ */
+
+#define TP_MAX_ENGINE_TABLES 8
+
+typedef struct {
+    const void* start;
+    size_t bytes;
+} engineTable_t;
+
+int tp_engine_tables(int engine, engineTable_t tables[TP_MAX_ENGINE_TABLES]);
+int tp_adaptive_tables(engineTable_t tables[TP_MAX_ENGINE_TABLES]);
+
+/*
+ * Fixed-point formatting of scaled integers (fixed.c).
+ * `scale` is the number of fractional digits: uitoa_fixed(1234, 2, 0, out) writes "12.34",
+ * uitoa_fixed(120, 6, 0, out) writes "0.000120".
+ * The output needs room for max(scale, digits) + 3 bytes. Returns the length written, or -1 for a negative scale.
+ */
+
+#define TP_FIXED_TRIM_ZEROS 1 // drop trailing fractional zeros, and the point too if nothing is left after it
+
+int uitoa_fixed(uint32_t value, int scale, int flags, char* out);
+int uitoa_fixed64(uint64_t value, int scale, int flags, char* out);
+
+/*
+ * printf("%.*f")-style formatting of doubles (fixed.c), rounded exactly like printf in the default rounding mode.
+ * The value is scaled and rounded into a 64-bit integer and written by uitoa_fixed64; NaN, infinities, precisions
+ * above 19 and values that don't fit go through snprintf. `out` needs TP_DTOA_FIXED_BUFSIZE bytes, which holds any
+ * double up to precision 40. Returns the length written, or -1 with `out` empty if the text would need more.
+ */
+
+#define TP_DTOA_FIXED_BUFSIZE 352 // "-" + 309 integer places of DBL_MAX + "." + fallback precision + NUL, with headroom
+
+int dtoa_fixed(double value, int precision, char* out);
+
+/*
+ * Conversion to bases 2-36 with lowercase letters (radix.c). `a` needs 33 bytes for base 2; 11 cover base 10.
+ * uitoa_radix dispatches on `base` at runtime and returns the length, or -1 for a base outside 2-36.
+ * The per-base functions are the ones generated into radix_tables.h (see genradix.py); uitoa_radix_tables
+ * reports their tables like tp_engine_tables does, or returns -1 for a base that wasn't generated.
+ */
+
+int uitoa_radix(uint32_t i, int base, char* a);
+int uitoa_radix2(uint32_t i, char* a);
+int uitoa_radix8(uint32_t i, char* a);
+int uitoa_radix10(uint32_t i, char* a);
+int uitoa_radix16(uint32_t i, char* a);
+int uitoa_radix36(uint32_t i, char* a);
+int uitoa_radix_tables(int base, engineTable_t tables[TP_MAX_ENGINE_TABLES]);
+
+/*
+ * Dotted-quad IPv4 formatting (ipv4.c). `address` is in host order, so 0x7f000001 is "127.0.0.1".
+ * `out` needs 16 bytes. Returns the length written.
+ */
+
+int format_ipv4(uint32_t address, char* out);
+
+/*
+ * ISO-8601 UTC timestamps from nanoseconds since the Unix epoch (iso8601.c), e.g. "2024-03-01T12:34:56.789Z".
+ * `frac_digits` (0-9) places of the second are kept, truncated. `out` needs 32 bytes. Returns the length written.
+ * The cached variant reuses the "YYYY-MM-DDTHH:MM:SS" prefix while consecutive calls fall in the same second;
+ * zero-initialize the cache before first use and don't share it between threads.
+ */
+
+typedef struct {
+    int64_t second;
+    int valid;
+    char prefix[19];
+} iso8601Cache_t;
+
+int format_iso8601(int64_t epoch_nanos, char* out, int frac_digits);
+int format_iso8601_cached(iso8601Cache_t* cache, int64_t epoch_nanos, char* out, int frac_digits);
+
+/*
+ * Deferred formatting (logring.c): hot threads push raw values into a lock-free ring, and a background thread
+ * converts them in batches and passes the text, one value per line, to `sink`.
+ * logring_push never blocks; it returns -1 when the ring is full. Any number of threads may push.
+ * logring_destroy converts everything pushed before it was called, then stops the thread.
+ * Link with -pthread.
+ */
+
+#define TP_LOG_U32 0
+#define TP_LOG_U64 1
+#define TP_LOG_I64 2
+
+typedef struct logRing logRing_t;
+typedef void (*logSink_t)(const char* text, size_t length, void* context);
+
+logRing_t* logring_create(size_t capacity, logSink_t sink, void* context);
+int logring_push(logRing_t* ring, uint64_t value, int tag);
+void logring_destroy(logRing_t* ring);
+
+/*
+ * Arena-backed pool of converted integers (strpool.c). Each call returns a view of the text, which stays valid
+ * (and NUL-terminated) until strpool_reset or strpool_destroy. strpool_reset is O(1) and keeps the arena's memory.
+ * With TP_POOL_INTERN, converting the same value twice between resets returns the same view, unless the intern
+ * table couldn't grow to hold it, in which case each call gets its own copy.
+ * `chunkSize` is the arena's allocation granularity; pass 0 for 64 KiB. A failed allocation returns {NULL, 0}.
+ */
+
+#define TP_POOL_INTERN 1
+
+typedef struct {
+    const char* ptr;
+    uint32_t len;
+} stringView_t;
+
+typedef struct stringPool stringPool_t;
+
+stringPool_t* strpool_create(size_t chunkSize, int flags);
+stringView_t strpool_u32(stringPool_t* pool, uint32_t value);
+stringView_t strpool_u64(stringPool_t* pool, uint64_t value);
+void strpool_reset(stringPool_t* pool);
+size_t strpool_bytes_used(const stringPool_t* pool);
+void strpool_destroy(stringPool_t* pool);
+
+/*
+ * Integer columns to Arrow-style string columns (columnar.c): row i's text is data[offsets[i], offsets[i+1]).
+ * _measure fills `offsets` (count + 1 entries) and returns the data size, or SIZE_MAX if it would pass INT32_MAX;
+ * _fill then writes every row into a data buffer of that size, split across up to `threads` threads.
+ */
+
+size_t tp_column_u32_measure(const uint32_t* values, size_t count, int32_t* offsets);
+size_t tp_column_u64_measure(const uint64_t* values, size_t count, int32_t* offsets);
+void tp_column_u32_fill(const uint32_t* values, size_t count, const int32_t* offsets, char* data, int threads);
+void tp_column_u64_fill(const uint64_t* values, size_t count, const int32_t* offsets, char* data, int threads);
+
+/*
+ * The same columns built NUMA-aware (numa.c): workers pinned per node, lookup tables replicated into each node's
+ * memory, and the data buffer first touched by the worker filling each part of it. Measures into `offsets`
+ * itself and returns the mapped data buffer (free it with tp_numa_free), or NULL if the text won't fit int32
+ * offsets or memory runs out. threads < 1 means one per CPU. TP_NUMA_REMOTE misplaces tables and output on
+ * purpose, for comparison.
+ */
+
+#define TP_NUMA_REMOTE 1
+
+int tp_numa_nodes(void);
+char* tp_numa_column_u32(const uint32_t* values, size_t count, int32_t* offsets, size_t* dataSize, int threads, int flags);
+char* tp_numa_column_u64(const uint64_t* values, size_t count, int32_t* offsets, size_t* dataSize, int threads, int flags);
+void tp_numa_free(char* data, size_t dataSize);
+
+/*
+ * Integer arrays as JSON arrays, e.g. "[1,22,333]" (json.c). `out` must hold TP_JSON_ARRAY_*_MAX(count) bytes,
+ * the worst case including the terminator; with less, nothing is written and -1 is returned.
+ * Otherwise returns the length written, terminator excluded.
+ */
+
+#define TP_JSON_ARRAY_U32_MAX(count) (3 + (size_t)(count) * 11)
+#define TP_JSON_ARRAY_U64_MAX(count) (3 + (size_t)(count) * 21)
+#define TP_JSON_ARRAY_I64_MAX(count) (3 + (size_t)(count) * 22)
+
+int64_t tp_json_array_u32(const uint32_t* values, size_t count, char* out, size_t capacity);
+int64_t tp_json_array_u64(const uint64_t* values, size_t count, char* out, size_t capacity);
+int64_t tp_json_array_i64(const int64_t* values, size_t count, char* out, size_t capacity);
+
+/*
+ * LEB128 varints decoded and formatted in one step (varint.c).
+ * tp_varint_format converts the varint at `in` into `out` (21 bytes) and stores the bytes it used in `consumed`.
+ * tp_varint_format_batch converts consecutive varints, each followed by `separator`, for as long as input remains
+ * and `out` has 21 bytes to spare; `consumed` tells where it stopped. Both return the characters written, or -1
+ * on a truncated or overlong varint (with `consumed` at its start, for the batch).
+ */
+
+int tp_varint_format(const uint8_t* in, size_t available, size_t* consumed, char* out);
+int64_t tp_varint_format_batch(const uint8_t* in, size_t size, size_t* consumed, char* out, size_t capacity, char separator);
+
+/*
+ * Overlapped file output (asyncwrite.c): up to `depth` caller-owned buffers are written through io_uring while
+ * the caller fills the next one. Each buffer is handed back exactly once through `done` with its `tag` and `error`,
+ * which is 0 once it is written or the errno of its failed write; that includes a submit that returns -1.
+ * asyncwriter_poll collects finished writes without blocking and returns how many are still in flight; call it
+ * while idle so buffers come back promptly.
+ * TP_WRITER_PWRITE forces the plain pwrite path that is also used when io_uring is unavailable.
+ * submit and close return -1 with errno set after any failed write.
+ */
+
+#define TP_WRITER_PWRITE 1
+
+typedef struct asyncWriter asyncWriter_t;
+typedef void (*writeDone_t)(void* context, void* tag, int error);
+
+typedef struct {
+    const char* backend; // "io_uring" or "pwrite"
+    uint64_t writes;
+    uint64_t bytes;
+    double busySeconds;    // time with at least one write in flight
+    double stalledSeconds; // time the caller spent waiting on writes
+    double overlap;        // 1 - stalled / busy: the share of write time hidden behind the caller's work
+} asyncWriterStats_t;
+
+asyncWriter_t* asyncwriter_open(const char* path, int depth, int flags, writeDone_t done, void* context);
+int asyncwriter_submit(asyncWriter_t* writer, const void* data, size_t length, void* tag);
+int asyncwriter_poll(asyncWriter_t* writer);
+int asyncwriter_close(asyncWriter_t* writer, asyncWriterStats_t* stats);
+
+/*
+ * snprintf with %d/%i/%u done by the toothpaste engines (tp_printf.c); other conversions go through libc.
+ * Same return value and truncation rules as snprintf. Formats are compiled on first use and cached per thread;
+ * tp_format_compile/tp_snprintf_compiled skip even the cache lookup for a format used in a hot loop.
+ */
+
+typedef struct compiledFormat compiledFormat_t;
+
+int tp_snprintf(char* buffer, size_t size, const char* format, ...);
+int tp_vsnprintf(char* buffer, size_t size, const char* format, va_list arguments);
+compiledFormat_t* tp_format_compile(const char* format);
+void tp_format_free(compiledFormat_t* compiled);
+int tp_snprintf_compiled(char* buffer, size_t size, const compiledFormat_t* compiled, ...);
+int tp_vsnprintf_compiled(char* buffer, size_t size, const compiledFormat_t* compiled, va_list arguments);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef TOOTHPASTE_HPP
+#define TOOTHPASTE_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <array>
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "toothpaste.h"
+#include "toothpaste_tables.h"
+
+/*
+ * C++ form of the toothpaste engine, usable in constant expressions.
+ *
+ * The ROMs and carry tables are the ones in toothpaste_tables.h, taken in as constexpr copies, so compile-time
+ * and runtime conversions run on the same data. static_asserts check every ROM entry against repeated doubling,
+ * and make the slot-overflow argument that test.py makes for one bit width for both widths here.
+ *
+ * toothpaste::to_chars is a drop-in for std::to_chars on integers. It isn't constexpr: it runs the C engines
+ * from toothpaste.c, picked by the width of T, so link that in when using it.
+ *
+ * Requires C++17.
+ *
+ *     constexpr auto name = toothpaste::to_string_v<12345>;  // name.view() == "12345", built by the compiler
+ *     auto text = toothpaste::to_string(x);                  // same engine at runtime, no allocation
+ *     auto [end, error] = toothpaste::to_chars(first, last, x);
+ */
+
+namespace toothpaste {
+
+// A string of at most Capacity characters, stored inline and NUL-terminated.
+template <size_t Capacity>
+struct fixed_string {
+    char data[Capacity + 1] = {};
+    size_t length = 0;
+
+    constexpr const char* c_str() const { return data; }
+    constexpr size_t size() const { return length; }
+    constexpr std::string_view view() const { return std::string_view(data, length); }
+    constexpr operator std::string_view() const { return view(); }
+};
+
+namespace detail {
+
+// decimal places in 2^Bits - 1
+constexpr int digitCount(int bits) {
+    uint64_t largest = bits == 64 ? ~0ull : (1ull << bits) - 1;
+    int count = 1;
+    while (largest >= 10) {
+        largest /= 10;
+        count++;
+    }
+    return count;
+}
+
+// how many ROM entries are added between squeezes; 32 is what keeps 64-bit slots below 256
+constexpr int squeezePeriod = 32;
+
+// constexpr copies of the tables toothpaste.c exports, from the same initializers
+inline constexpr fullDecimal32_t sharedROM[32] = TOOTHPASTE_DECIMAL_ROM_INIT;
+inline constexpr fullDecimal64_t sharedROM64[64] = TOOTHPASTE_DECIMAL_ROM64_INIT;
+inline constexpr uint8_t sharedQuotients[256] = TOOTHPASTE_QUOTIENTS_INIT;
+inline constexpr uint8_t sharedRemainders[256] = TOOTHPASTE_REMAINDERS_INIT;
+
+template <int Bits>
+struct rom {
+    static_assert(Bits == 32 || Bits == 64, "the ROMs are 32 and 64 bits wide");
+    static constexpr int digits = digitCount(Bits);
+    using decimal = std::array<uint8_t, digits>;
+
+    std::array<decimal, Bits> entries{}; // entries[0] is the most significant bit, as in decimalROM
+
+    constexpr rom() {
+        for (int bit = 0; bit < Bits; bit++) {
+            for (int d = 0; d < digits; d++) {
+                if constexpr (Bits == 32) {
+                    entries[bit][d] = sharedROM[bit].digits[d];
+                } else {
+                    entries[bit][d] = sharedROM64[bit].digits[d];
+                }
+            }
+        }
+    }
+};
+
+template <int Bits>
+inline constexpr rom<Bits> romFor{};
+
+// the written-out ROM against 2^(Bits-1) ... 2^0 worked out by repeated doubling
+template <int Bits>
+constexpr bool romIsPowersOfTwo() {
+    constexpr int digits = rom<Bits>::digits;
+    typename rom<Bits>::decimal power{};
+    power[digits - 1] = 1;
+    for (int bit = 0; bit < Bits; bit++) {
+        for (int d = 0; d < digits; d++) {
+            if (romFor<Bits>.entries[Bits - 1 - bit][d] != power[d]) return false;
+        }
+        int carry = 0;
+        for (int d = digits - 1; d >= 0; d--) {
+            int doubled = power[d] * 2 + carry;
+            power[d] = (uint8_t)(doubled % 10);
+            carry = doubled / 10;
+        }
+    }
+    return true;
+}
+
+struct carryTables {
+    std::array<uint8_t, 256> quotients{};
+    std::array<uint8_t, 256> remainders{};
+
+    constexpr carryTables() {
+        for (int v = 0; v < 256; v++) {
+            quotients[v] = sharedQuotients[v];
+            remainders[v] = sharedRemainders[v];
+        }
+    }
+};
+
+inline constexpr carryTables carry{};
+
+constexpr bool carryTablesDivide() {
+    for (int v = 0; v < 256; v++) {
+        if (carry.quotients[v] != v / 10 || carry.remainders[v] != v % 10) return false;
+    }
+    return true;
+}
+
+// test.py's check: the worst case (every bit set) must stay within a byte, both while adding and while carrying
+template <int Bits>
+constexpr bool slotsFit() {
+    constexpr int digits = rom<Bits>::digits;
+    int slots[digits] = {};
+    for (int bit = 0; bit < Bits; bit++) {
+        for (int d = 0; d < digits; d++) {
+            slots[d] += romFor<Bits>.entries[bit][d];
+            if (slots[d] > 255) return false;
+        }
+        if ((bit + 1) % squeezePeriod == 0 || bit == Bits - 1) {
+            for (int d = digits - 1; d > 0; d--) {
+                slots[d-1] += slots[d] / 10;
+                slots[d] %= 10;
+                if (slots[d-1] > 255) return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <int Bits>
+constexpr typename rom<Bits>::decimal uitodec(uint64_t value) {
+    static_assert(romIsPowersOfTwo<Bits>(), "toothpaste_tables.h has a wrong ROM entry");
+    static_assert(carryTablesDivide(), "toothpaste_tables.h has a wrong carry table entry");
+    static_assert(slotsFit<Bits>(), "a decimal slot can overflow for this bit width");
+    typename rom<Bits>::decimal accumulator{};
+    for (int bit = 0; bit < Bits; bit++) {
+        if ((value >> (Bits - 1 - bit)) & 1) {
+            for (int d = 0; d < rom<Bits>::digits; d++) accumulator[d] += romFor<Bits>.entries[bit][d];
+        }
+        if ((bit + 1) % squeezePeriod == 0 || bit == Bits - 1) {
+            // squeeze the accumulated carries from right to left, like a toothpaste tube.
+            for (int d = rom<Bits>::digits - 1; d > 0; d--) {
+                accumulator[d-1] += carry.quotients[accumulator[d]];
+                accumulator[d] = carry.remainders[accumulator[d]];
+            }
+        }
+    }
+    return accumulator;
+}
+
+// the engine width for an integer type: 32 bits covers everything up to int32_t, and 64 the rest up to 64 bits;
+// wider types such as __int128 are rejected by to_string and to_chars
+template <typename T>
+constexpr int engineBits() {
+    return std::numeric_limits<T>::digits + std::is_signed<T>::value > 32 ? 64 : 32;
+}
+
+template <typename T>
+using unsigned_of = std::make_unsigned_t<T>;
+
+// |value| as an unsigned of the same width, without overflowing on the minimum
+template <typename T>
+constexpr unsigned_of<T> magnitude(T value) {
+    if constexpr (std::is_signed<T>::value) {
+        return value < 0 ? (unsigned_of<T>)(0 - (unsigned_of<T>)value) : (unsigned_of<T>)value;
+    } else {
+        return value;
+    }
+}
+
+} // namespace detail
+
+// the most characters to_string can produce for T, sign included
+template <typename T>
+constexpr size_t max_chars = detail::digitCount(detail::engineBits<T>()) + std::is_signed<T>::value;
+
+template <typename T>
+constexpr fixed_string<max_chars<T>> to_string(T value) {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "to_string takes integers");
+    static_assert(std::numeric_limits<T>::digits <= 64, "the engines are at most 64 bits wide");
+    constexpr int bits = detail::engineBits<T>();
+    constexpr int digits = detail::rom<bits>::digits;
+    fixed_string<max_chars<T>> text;
+    auto decimal = detail::uitodec<bits>(detail::magnitude(value));
+    int decimalPtr = 0;
+
+    if constexpr (std::is_signed<T>::value) {
+        if (value < 0) text.data[text.length++] = '-';
+    }
+    while (decimalPtr < digits - 1 && decimal[decimalPtr] == 0) decimalPtr++;
+    while (decimalPtr < digits) text.data[text.length++] = (char)('0' + decimal[decimalPtr++]);
+    text.data[text.length] = '\0';
+    return text;
+}
+
+// the decimal text of a constant, computed entirely at compile time
+template <auto Value>
+inline constexpr auto to_string_v = to_string(Value);
+
+static_assert(to_string_v<0u>.view() == "0");
+static_assert(to_string_v<4294967295u>.view() == "4294967295");
+static_assert(to_string_v<INT32_MIN>.view() == "-2147483648");
+static_assert(to_string_v<4294967296ull>.view() == "4294967296");
+static_assert(to_string_v<UINT64_MAX>.view() == "18446744073709551615");
+static_assert(to_string_v<INT64_MIN>.view() == "-9223372036854775808");
+
+/*
+ * Same contract as std::to_chars(first, last, value) in base 10: on success the result points one past the last
+ * character written and nothing is NUL-terminated; if the text doesn't fit, it returns {last, value_too_large}
+ * and the contents of [first, last) are unspecified.
+ */
+template <typename T>
+std::to_chars_result to_chars(char* first, char* last, T value) {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "to_chars takes integers");
+    static_assert(std::numeric_limits<T>::digits <= 64, "the engines are at most 64 bits wide");
+    char text[max_chars<T> + 1]; // the fillBuffer functions also write a terminator
+    int length = 0;
+    auto unsignedValue = detail::magnitude(value);
+
+    if constexpr (std::is_signed<T>::value) {
+        if (value < 0) text[length++] = '-';
+    }
+    if constexpr (std::numeric_limits<decltype(unsignedValue)>::digits <= 8) {
+        length += fillBuffer8(uitodec8((uint8_t)unsignedValue), text + length);
+    } else if constexpr (std::numeric_limits<decltype(unsignedValue)>::digits <= 32) {
+        length += fillBuffer(uitodec((uint32_t)unsignedValue), text + length);
+    } else {
+        length += fillBuffer64(uitodec64((uint64_t)unsignedValue), text + length);
+    }
+
+    if (last - first < length) return {last, std::errc::value_too_large};
+    memcpy(first, text, length);
+    return {first + length, std::errc()};
+}
+
+} // namespace toothpaste
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef TOOTHPASTE_CORE_H
+#define TOOTHPASTE_CORE_H
+
+#include <stdint.h>
+
+#include "toothpaste.h"
+#include "toothpaste_tables.h"
+
+/*
+ * Pieces of the engine shared between translation units.
+ *
+ * The tables themselves are written out once, in toothpaste_tables.h.
+ *
+ * The accumulate and squeeze steps, taking their tables as pointers. uitodec and uitodec64 call them
+ * with the exported tables; numa.c calls them with per-node replicas.
+ */
+
+// fully unrolled loops are what let a constant input fold all the way down in toothpaste_inline.h
+#if defined(__GNUC__) && !defined(__clang__)
+#define TOOTHPASTE_UNROLL(n) _Pragma(TOOTHPASTE_STRINGIFY(GCC unroll n))
+#elif defined(__clang__)
+#define TOOTHPASTE_UNROLL(n) _Pragma(TOOTHPASTE_STRINGIFY(clang loop unroll(full)))
+#else
+#define TOOTHPASTE_UNROLL(n)
+#endif
+#define TOOTHPASTE_STRINGIFY(x) #x
+
+static inline fullDecimal32_t accumulate32(uint32_t i, const fullDecimal32_t* rom) {
+    fullDecimal32_t accumulator = {.arith = {0, 0}};
+    int8_t count = 0;
+    while (i) {
+        if (i & 0x80000000u) {
+            accumulator.arith.high += rom[count].arith.high;
+            accumulator.arith.low += rom[count].arith.low;
+        }
+        count++;
+        i <<= 1;
+    }
+    return accumulator;
+}
+
+// squeeze the accumulated carries from right to left, like a toothpaste tube.
+static inline void squeeze32(fullDecimal32_t* accumulator, const uint8_t* quotients, const uint8_t* remainders) {
+    TOOTHPASTE_UNROLL(9)
+    for (int i = 9; i > 0; i--) {
+        accumulator->digits[i-1] += quotients[accumulator->digits[i]];
+        accumulator->digits[i] = remainders[accumulator->digits[i]];
+    }
+}
+
+static inline void squeeze64(fullDecimal64_t* accumulator, const uint8_t* quotients, const uint8_t* remainders) {
+    for (int i = 19; i > 0; i--) {
+        accumulator->digits[i-1] += quotients[accumulator->digits[i]];
+        accumulator->digits[i] = remainders[accumulator->digits[i]];
+    }
+}
+
+static inline fullDecimal32_t uitodecTables(uint32_t i, const fullDecimal32_t* rom, const uint8_t* quotients, const uint8_t* remainders) {
+    fullDecimal32_t accumulator = accumulate32(i, rom);
+    squeeze32(&accumulator, quotients, remainders);
+    return accumulator;
+}
+
+static inline fullDecimal64_t uitodec64Tables(uint64_t i, const fullDecimal64_t* rom64, const uint8_t* quotients, const uint8_t* remainders) {
+    fullDecimal64_t accumulator = {.arith = {0, 0, 0}};
+    // two halves of 32 adds each, with a squeeze in between so no slot passes 255.
+    for (int half = 0; half < 2; half++) {
+        uint32_t bits = half ? (uint32_t)i : (uint32_t)(i >> 32);
+        int8_t count = half * 32;
+        while (bits) {
+            if (bits & 0x80000000u) {
+                accumulator.arith.high += rom64[count].arith.high;
+                accumulator.arith.mid += rom64[count].arith.mid;
+                accumulator.arith.low += rom64[count].arith.low;
+            }
+            count++;
+            bits <<= 1;
+        }
+        squeeze64(&accumulator, quotients, remainders);
+    }
+    return accumulator;
+}
+
+#endif
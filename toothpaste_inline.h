@@ -0,0 +1,56 @@
+#ifndef TOOTHPASTE_INLINE_H
+#define TOOTHPASTE_INLINE_H
+
+#include <stdint.h>
+
+#include "toothpaste.h"
+#include "toothpaste_core.h"
+
+/*
+ * Header-only build of the 32-bit engine.
+ *
+ * Everything here is `static inline` over `static const` tables, so each translation unit gets its own copy the
+ * optimizer can see through: calls inline into the caller without LTO, and a conversion whose input is known
+ * at compile time can fold down to storing the finished string. The functions carry an _inline suffix so
+ * this header can sit next to toothpaste.h (whose types it reuses) and toothpaste.c in the same program.
+ * Nothing needs to be linked.
+ */
+
+// copies of the tables in toothpaste_tables.h, private to this translation unit
+static const fullDecimal32_t inlineDecimalROM[32] = TOOTHPASTE_DECIMAL_ROM_INIT;
+static const uint8_t inlineQuotients[256] = TOOTHPASTE_QUOTIENTS_INIT;
+static const uint8_t inlineRemainders[256] = TOOTHPASTE_REMAINDERS_INIT;
+
+static inline fullDecimal32_t uitodec_inline(uint32_t i) {
+    fullDecimal32_t accumulator = {.arith = {0, 0}};
+    TOOTHPASTE_UNROLL(32)
+    for (int count = 0; count < 32; count++) {
+        if (i & (0x80000000u >> count)) {
+            accumulator.arith.high += inlineDecimalROM[count].arith.high;
+            accumulator.arith.low += inlineDecimalROM[count].arith.low;
+        }
+    }
+    squeeze32(&accumulator, inlineQuotients, inlineRemainders);
+    return accumulator;
+}
+
+static inline int fillBuffer_inline(fullDecimal32_t decimal, char buffer[11]) {
+    int leading = 0;
+    // fixed trip counts, so these unroll too; the last digit is always kept so 0 prints as "0"
+    TOOTHPASTE_UNROLL(9)
+    for (int decimalPtr = 0; decimalPtr < 9; decimalPtr++) {
+        leading += leading == decimalPtr && decimal.digits[decimalPtr] == 0;
+    }
+    TOOTHPASTE_UNROLL(10)
+    for (int decimalPtr = 0; decimalPtr < 10; decimalPtr++) {
+        if (decimalPtr >= leading) buffer[decimalPtr - leading] = decimal.digits[decimalPtr] + '0';
+    }
+    buffer[10 - leading] = '\0';
+    return 10 - leading;
+}
+
+static inline int uitoa_inline(uint32_t i, char* a) {
+    return fillBuffer_inline(uitodec_inline(i), a);
+}
+
+#endif
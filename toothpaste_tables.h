@@ -0,0 +1,142 @@
+#ifndef TOOTHPASTE_TABLES_H
+#define TOOTHPASTE_TABLES_H
+
+/*
+ * The one written-out copy of the decimal ROMs and the carry tables, as initializers.
+ *
+ * toothpaste.c builds the exported decimalROM, decimalROM64, quotients and remainders from these,
+ * toothpaste_inline.h builds `static const` copies so the optimizer can see their contents, and toothpaste.hpp
+ * builds `constexpr` copies for compile-time conversion. A change here reaches all three.
+ *
+ * `digits` is the first member of each fullDecimal union, so the entries need no designator and the same text
+ * is valid C and C++.
+ */
+
+// decimalROM[count] is 2^(31 - count), one digit per byte
+#define TOOTHPASTE_DECIMAL_ROM_INIT { \
+    { {2, 1, 4, 7, 4, 8, 3, 6, 4, 8} }, /* 2^31 = 2147483648 */ \
+    { {1, 0, 7, 3, 7, 4, 1, 8, 2, 4} }, /* 2^30 = 1073741824 */ \
+    { {0, 5, 3, 6, 8, 7, 0, 9, 1, 2} }, /* 2^29 = 536870912 */ \
+    { {0, 2, 6, 8, 4, 3, 5, 4, 5, 6} }, /* 2^28 = 268435456 */ \
+    { {0, 1, 3, 4, 2, 1, 7, 7, 2, 8} }, /* 2^27 = 134217728 */ \
+    { {0, 0, 6, 7, 1, 0, 8, 8, 6, 4} }, /* 2^26 =  67108864 */ \
+    { {0, 0, 3, 3, 5, 5, 4, 4, 3, 2} }, /* 2^25 =  33554432 */ \
+    { {0, 0, 1, 6, 7, 7, 7, 2, 1, 6} }, /* 2^24 =  16777216 */ \
+    { {0, 0, 0, 8, 3, 8, 8, 6, 0, 8} }, /* 2^23 =   8388608 */ \
+    { {0, 0, 0, 4, 1, 9, 4, 3, 0, 4} }, /* 2^22 =   4194304 */ \
+    { {0, 0, 0, 2, 0, 9, 7, 1, 5, 2} }, /* 2^21 =   2097152 */ \
+    { {0, 0, 0, 1, 0, 4, 8, 5, 7, 6} }, /* 2^20 =   1048576 */ \
+    { {0, 0, 0, 0, 5, 2, 4, 2, 8, 8} }, /* 2^19 =    524288 */ \
+    { {0, 0, 0, 0, 2, 6, 2, 1, 4, 4} }, /* 2^18 =    262144 */ \
+    { {0, 0, 0, 0, 1, 3, 1, 0, 7, 2} }, /* 2^17 =    131072 */ \
+    { {0, 0, 0, 0, 0, 6, 5, 5, 3, 6} }, /* 2^16 =     65536 */ \
+    { {0, 0, 0, 0, 0, 3, 2, 7, 6, 8} }, /* 2^15 =     32768 */ \
+    { {0, 0, 0, 0, 0, 1, 6, 3, 8, 4} }, /* 2^14 =     16384 */ \
+    { {0, 0, 0, 0, 0, 0, 8, 1, 9, 2} }, /* 2^13 =      8192 */ \
+    { {0, 0, 0, 0, 0, 0, 4, 0, 9, 6} }, /* 2^12 =      4096 */ \
+    { {0, 0, 0, 0, 0, 0, 2, 0, 4, 8} }, /* 2^11 =      2048 */ \
+    { {0, 0, 0, 0, 0, 0, 1, 0, 2, 4} }, /* 2^10 =      1024 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 5, 1, 2} }, /* 2^9  =       512 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 2, 5, 6} }, /* 2^8  =       256 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 1, 2, 8} }, /* 2^7  =       128 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 6, 4} }, /* 2^6  =        64 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 3, 2} }, /* 2^5  =        32 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 1, 6} }, /* 2^4  =        16 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 8} }, /* 2^3  =         8 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 4} }, /* 2^2  =         4 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 2} }, /* 2^1  =         2 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 1} }  /* 2^0  =         1 */ \
+}
+
+// decimalROM64[count] is 2^(63 - count)
+#define TOOTHPASTE_DECIMAL_ROM64_INIT { \
+    { {0, 9, 2, 2, 3, 3, 7, 2, 0, 3, 6, 8, 5, 4, 7, 7, 5, 8, 0, 8} }, /* 2^63 =  9223372036854775808 */ \
+    { {0, 4, 6, 1, 1, 6, 8, 6, 0, 1, 8, 4, 2, 7, 3, 8, 7, 9, 0, 4} }, /* 2^62 =  4611686018427387904 */ \
+    { {0, 2, 3, 0, 5, 8, 4, 3, 0, 0, 9, 2, 1, 3, 6, 9, 3, 9, 5, 2} }, /* 2^61 =  2305843009213693952 */ \
+    { {0, 1, 1, 5, 2, 9, 2, 1, 5, 0, 4, 6, 0, 6, 8, 4, 6, 9, 7, 6} }, /* 2^60 =  1152921504606846976 */ \
+    { {0, 0, 5, 7, 6, 4, 6, 0, 7, 5, 2, 3, 0, 3, 4, 2, 3, 4, 8, 8} }, /* 2^59 =   576460752303423488 */ \
+    { {0, 0, 2, 8, 8, 2, 3, 0, 3, 7, 6, 1, 5, 1, 7, 1, 1, 7, 4, 4} }, /* 2^58 =   288230376151711744 */ \
+    { {0, 0, 1, 4, 4, 1, 1, 5, 1, 8, 8, 0, 7, 5, 8, 5, 5, 8, 7, 2} }, /* 2^57 =   144115188075855872 */ \
+    { {0, 0, 0, 7, 2, 0, 5, 7, 5, 9, 4, 0, 3, 7, 9, 2, 7, 9, 3, 6} }, /* 2^56 =    72057594037927936 */ \
+    { {0, 0, 0, 3, 6, 0, 2, 8, 7, 9, 7, 0, 1, 8, 9, 6, 3, 9, 6, 8} }, /* 2^55 =    36028797018963968 */ \
+    { {0, 0, 0, 1, 8, 0, 1, 4, 3, 9, 8, 5, 0, 9, 4, 8, 1, 9, 8, 4} }, /* 2^54 =    18014398509481984 */ \
+    { {0, 0, 0, 0, 9, 0, 0, 7, 1, 9, 9, 2, 5, 4, 7, 4, 0, 9, 9, 2} }, /* 2^53 =     9007199254740992 */ \
+    { {0, 0, 0, 0, 4, 5, 0, 3, 5, 9, 9, 6, 2, 7, 3, 7, 0, 4, 9, 6} }, /* 2^52 =     4503599627370496 */ \
+    { {0, 0, 0, 0, 2, 2, 5, 1, 7, 9, 9, 8, 1, 3, 6, 8, 5, 2, 4, 8} }, /* 2^51 =     2251799813685248 */ \
+    { {0, 0, 0, 0, 1, 1, 2, 5, 8, 9, 9, 9, 0, 6, 8, 4, 2, 6, 2, 4} }, /* 2^50 =     1125899906842624 */ \
+    { {0, 0, 0, 0, 0, 5, 6, 2, 9, 4, 9, 9, 5, 3, 4, 2, 1, 3, 1, 2} }, /* 2^49 =      562949953421312 */ \
+    { {0, 0, 0, 0, 0, 2, 8, 1, 4, 7, 4, 9, 7, 6, 7, 1, 0, 6, 5, 6} }, /* 2^48 =      281474976710656 */ \
+    { {0, 0, 0, 0, 0, 1, 4, 0, 7, 3, 7, 4, 8, 8, 3, 5, 5, 3, 2, 8} }, /* 2^47 =      140737488355328 */ \
+    { {0, 0, 0, 0, 0, 0, 7, 0, 3, 6, 8, 7, 4, 4, 1, 7, 7, 6, 6, 4} }, /* 2^46 =       70368744177664 */ \
+    { {0, 0, 0, 0, 0, 0, 3, 5, 1, 8, 4, 3, 7, 2, 0, 8, 8, 8, 3, 2} }, /* 2^45 =       35184372088832 */ \
+    { {0, 0, 0, 0, 0, 0, 1, 7, 5, 9, 2, 1, 8, 6, 0, 4, 4, 4, 1, 6} }, /* 2^44 =       17592186044416 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 8, 7, 9, 6, 0, 9, 3, 0, 2, 2, 2, 0, 8} }, /* 2^43 =        8796093022208 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 4, 3, 9, 8, 0, 4, 6, 5, 1, 1, 1, 0, 4} }, /* 2^42 =        4398046511104 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 2, 1, 9, 9, 0, 2, 3, 2, 5, 5, 5, 5, 2} }, /* 2^41 =        2199023255552 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 1, 0, 9, 9, 5, 1, 1, 6, 2, 7, 7, 7, 6} }, /* 2^40 =        1099511627776 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 5, 4, 9, 7, 5, 5, 8, 1, 3, 8, 8, 8} }, /* 2^39 =         549755813888 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 2, 7, 4, 8, 7, 7, 9, 0, 6, 9, 4, 4} }, /* 2^38 =         274877906944 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 1, 3, 7, 4, 3, 8, 9, 5, 3, 4, 7, 2} }, /* 2^37 =         137438953472 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 8, 7, 1, 9, 4, 7, 6, 7, 3, 6} }, /* 2^36 =          68719476736 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 4, 3, 5, 9, 7, 3, 8, 3, 6, 8} }, /* 2^35 =          34359738368 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 7, 1, 7, 9, 8, 6, 9, 1, 8, 4} }, /* 2^34 =          17179869184 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 5, 8, 9, 9, 3, 4, 5, 9, 2} }, /* 2^33 =           8589934592 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 2, 9, 4, 9, 6, 7, 2, 9, 6} }, /* 2^32 =           4294967296 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 4, 7, 4, 8, 3, 6, 4, 8} }, /* 2^31 =           2147483648 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 7, 3, 7, 4, 1, 8, 2, 4} }, /* 2^30 =           1073741824 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 3, 6, 8, 7, 0, 9, 1, 2} }, /* 2^29 =            536870912 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 6, 8, 4, 3, 5, 4, 5, 6} }, /* 2^28 =            268435456 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 3, 4, 2, 1, 7, 7, 2, 8} }, /* 2^27 =            134217728 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 7, 1, 0, 8, 8, 6, 4} }, /* 2^26 =             67108864 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 5, 5, 4, 4, 3, 2} }, /* 2^25 =             33554432 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 6, 7, 7, 7, 2, 1, 6} }, /* 2^24 =             16777216 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 3, 8, 8, 6, 0, 8} }, /* 2^23 =              8388608 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 1, 9, 4, 3, 0, 4} }, /* 2^22 =              4194304 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 9, 7, 1, 5, 2} }, /* 2^21 =              2097152 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 4, 8, 5, 7, 6} }, /* 2^20 =              1048576 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 2, 4, 2, 8, 8} }, /* 2^19 =               524288 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 6, 2, 1, 4, 4} }, /* 2^18 =               262144 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 3, 1, 0, 7, 2} }, /* 2^17 =               131072 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 5, 5, 3, 6} }, /* 2^16 =                65536 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 2, 7, 6, 8} }, /* 2^15 =                32768 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 6, 3, 8, 4} }, /* 2^14 =                16384 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 1, 9, 2} }, /* 2^13 =                 8192 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 9, 6} }, /* 2^12 =                 4096 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 4, 8} }, /* 2^11 =                 2048 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 4} }, /* 2^10 =                 1024 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 1, 2} }, /* 2^9  =                  512 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 5, 6} }, /* 2^8  =                  256 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 8} }, /* 2^7  =                  128 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 4} }, /* 2^6  =                   64 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 2} }, /* 2^5  =                   32 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 6} }, /* 2^4  =                   16 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8} }, /* 2^3  =                    8 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4} }, /* 2^2  =                    4 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2} }, /* 2^1  =                    2 */ \
+    { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1} }  /* 2^0  =                    1 */ \
+}
+
+// quotients[v] = v / 10 and remainders[v] = v % 10 for every byte value, so carrying needs no division
+#define TOOTHPASTE_QUOTIENTS_INIT { \
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, \
+    3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, \
+    6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, \
+    9, 9, 9, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12, \
+    12, 12, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, \
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, \
+    19, 19, 19, 19, 19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 22, 22, 22, 22, \
+    22, 22, 22, 22, 22, 22, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 25, 25, 25, 25, 25, 25 \
+}
+
+#define TOOTHPASTE_REMAINDERS_INIT { \
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, \
+    2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, \
+    4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, \
+    6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, \
+    8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, \
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, \
+    2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, \
+    4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5 \
+}
+
+#endif
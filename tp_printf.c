@@ -0,0 +1,440 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <wchar.h>
+#include <limits.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "toothpaste.h"
+
+/*
+ * A printf subset with the integer conversions routed through the toothpaste engines.
+ *
+ * %d, %i and %u, with every flag ('-', '0', '+', ' '), width, precision (including '*') and length modifier
+ * (hh, h, l, ll, j, z, t), are formatted here. Anything else (%f, %x, %p, %s with a width, ...) is rebuilt into
+ * a single-conversion spec and handed to libc's snprintf, so the output always matches printf.
+ * A bare %s is copied directly. %n is accepted but writes nothing.
+ *
+ * The format string is compiled into a list of segments, each a run of literal text (copied with one memcpy)
+ * followed by at most one conversion. tp_vsnprintf keeps the compiled forms of recent formats in a small
+ * per-thread cache keyed by pointer; a hit is confirmed by comparing the text with the cached copy, which is
+ * far cheaper than parsing it again and stays correct when a buffer is reused for a different format.
+ * A thread's cache is freed when the thread exits.
+ * Callers can also compile a format once themselves and use tp_snprintf_compiled.
+ */
+
+#define flagLeft 1
+#define flagZero 2
+#define flagPlus 4
+#define flagSpace 8
+#define flagAlternate 16
+
+#define notGiven -1
+#define fromArgument -2
+#define tooLarge -3 // written out past INT_MAX, which makes the whole call fail with EOVERFLOW, as in printf
+
+enum { lengthNone, lengthChar, lengthShort, lengthLong, lengthLongLong, lengthMax, lengthSize, lengthPtrdiff, lengthLongDouble };
+
+static const char* lengthModifiers[] = {"", "hh", "h", "l", "ll", "j", "z", "t", "L"};
+
+typedef struct {
+    uint32_t literalStart;
+    uint32_t literalLength;
+    char conversion; // '\0' when the segment is only trailing text
+    uint8_t flags;
+    uint8_t length;
+    int width;
+    int precision;
+} formatSegment_t;
+
+struct compiledFormat {
+    char* text;
+    size_t textLength;
+    int segmentCount;
+    formatSegment_t segments[];
+};
+
+// reads the digits of a width or precision, stopping short of signed overflow
+static int parseCount(const char** scan) {
+    int count = 0;
+    for (; **scan >= '0' && **scan <= '9'; (*scan)++) {
+        int digit = **scan - '0';
+        if (count == tooLarge) continue;
+        count = count > (INT_MAX - digit) / 10 ? tooLarge : count * 10 + digit;
+    }
+    return count;
+}
+
+compiledFormat_t* tp_format_compile(const char* format) {
+    size_t textLength = strlen(format);
+    int conversions = 0;
+    compiledFormat_t* compiled;
+    const char* scan;
+    formatSegment_t* segment;
+    size_t literalStart = 0;
+
+    // every '%' starts at most one segment, plus one for trailing text
+    for (scan = format; *scan; scan++) conversions += *scan == '%';
+    compiled = malloc(sizeof(compiledFormat_t) + (conversions + 1) * sizeof(formatSegment_t));
+    if (!compiled) return NULL;
+    compiled->text = malloc(textLength + 1);
+    if (!compiled->text) {
+        free(compiled);
+        return NULL;
+    }
+    memcpy(compiled->text, format, textLength + 1);
+    compiled->textLength = textLength;
+    compiled->segmentCount = 0;
+
+    scan = format;
+    while (*scan) {
+        const char* percent = strchr(scan, '%');
+        if (!percent) break;
+        if (percent[1] == '%') {
+            // keep "%%" as literal text: the segment ends after the first '%' and the next one starts after the second
+            segment = &compiled->segments[compiled->segmentCount++];
+            *segment = (formatSegment_t){literalStart, percent + 1 - format - literalStart, 0, 0, 0, notGiven, notGiven};
+            scan = percent + 2;
+            literalStart = scan - format;
+            continue;
+        }
+
+        segment = &compiled->segments[compiled->segmentCount++];
+        *segment = (formatSegment_t){literalStart, percent - format - literalStart, 0, 0, lengthNone, notGiven, notGiven};
+        scan = percent + 1;
+        for (;; scan++) {
+            if (*scan == '-') segment->flags |= flagLeft;
+            else if (*scan == '0') segment->flags |= flagZero;
+            else if (*scan == '+') segment->flags |= flagPlus;
+            else if (*scan == ' ') segment->flags |= flagSpace;
+            else if (*scan == '#') segment->flags |= flagAlternate;
+            else break;
+        }
+        if (*scan == '*') {
+            segment->width = fromArgument;
+            scan++;
+        } else if (*scan >= '0' && *scan <= '9') {
+            segment->width = parseCount(&scan);
+        }
+        if (*scan == '.') {
+            scan++;
+            if (*scan == '*') {
+                segment->precision = fromArgument;
+                scan++;
+            } else {
+                segment->precision = parseCount(&scan);
+            }
+        }
+        switch (*scan) {
+        case 'h': segment->length = scan[1] == 'h' ? lengthChar : lengthShort; scan += scan[1] == 'h' ? 2 : 1; break;
+        case 'l': segment->length = scan[1] == 'l' ? lengthLongLong : lengthLong; scan += scan[1] == 'l' ? 2 : 1; break;
+        case 'j': segment->length = lengthMax; scan++; break;
+        case 'z': segment->length = lengthSize; scan++; break;
+        case 't': segment->length = lengthPtrdiff; scan++; break;
+        case 'L': segment->length = lengthLongDouble; scan++; break;
+        }
+        if (!*scan) {
+            // a dangling '%' at the end prints nothing
+            segment->conversion = 0;
+            literalStart = textLength;
+            break;
+        }
+        segment->conversion = *scan++;
+        literalStart = scan - format;
+    }
+
+    segment = &compiled->segments[compiled->segmentCount++];
+    *segment = (formatSegment_t){literalStart, textLength - literalStart, 0, 0, 0, notGiven, notGiven};
+    if (segment->literalStart > textLength) segment->literalLength = 0;
+    return compiled;
+}
+
+void tp_format_free(compiledFormat_t* compiled) {
+    if (!compiled) return;
+    free(compiled->text);
+    free(compiled);
+}
+
+/* ---- output ---- */
+
+typedef struct {
+    char* buffer;
+    size_t capacity; // bytes we may write, the terminator excluded
+    size_t position; // bytes that would have been written so far
+} output_t;
+
+static void emit(output_t* out, const char* text, size_t length) {
+    if (out->position < out->capacity) {
+        size_t room = out->capacity - out->position;
+        memcpy(out->buffer + out->position, text, length < room ? length : room);
+    }
+    out->position += length;
+}
+
+static void emitRepeated(output_t* out, char c, size_t count) {
+    if (out->position < out->capacity) {
+        size_t room = out->capacity - out->position;
+        memset(out->buffer + out->position, c, count < room ? count : room);
+    }
+    out->position += count;
+}
+
+static void emitInteger(output_t* out, const formatSegment_t* segment, int width, int precision, uint64_t magnitude, int negative, int isSigned) {
+    char digits[21];
+    char sign = 0;
+    int digitCount;
+    // width and precision can each be up to INT_MAX, so the sums are worked out in 64 bits
+    int64_t zeros = 0, padding, total;
+    int flags = segment->flags;
+
+    // "%.0d" of 0 prints no digits at all
+    if (precision == 0 && magnitude == 0) digitCount = 0;
+    else if (magnitude <= UINT32_MAX) digitCount = fillBuffer(uitodec((uint32_t)magnitude), digits);
+    else digitCount = fillBuffer64(uitodec64(magnitude), digits);
+
+    if (negative) sign = '-';
+    else if (isSigned && (flags & flagPlus)) sign = '+';
+    else if (isSigned && (flags & flagSpace)) sign = ' ';
+
+    if (precision > digitCount) zeros = precision - digitCount;
+    total = (sign != 0) + zeros + digitCount;
+    padding = width > total ? width - total : 0;
+    // '0' pads with zeros after the sign, but only without a precision or '-'
+    if ((flags & flagZero) && !(flags & flagLeft) && precision < 0) {
+        zeros += padding;
+        padding = 0;
+    }
+
+    if (!(flags & flagLeft)) emitRepeated(out, ' ', padding);
+    if (sign) emit(out, &sign, 1);
+    emitRepeated(out, '0', zeros);
+    emit(out, digits, digitCount);
+    if (flags & flagLeft) emitRepeated(out, ' ', padding);
+}
+
+static int64_t signedArgument(int length, va_list* arguments) {
+    switch (length) {
+    case lengthChar: return (signed char)va_arg(*arguments, int);
+    case lengthShort: return (short)va_arg(*arguments, int);
+    case lengthLong: return va_arg(*arguments, long);
+    case lengthLongLong: return va_arg(*arguments, long long);
+    case lengthMax: return va_arg(*arguments, intmax_t);
+    case lengthSize: return va_arg(*arguments, ptrdiff_t);
+    case lengthPtrdiff: return va_arg(*arguments, ptrdiff_t);
+    default: return va_arg(*arguments, int);
+    }
+}
+
+static uint64_t unsignedArgument(int length, va_list* arguments) {
+    switch (length) {
+    case lengthChar: return (unsigned char)va_arg(*arguments, unsigned);
+    case lengthShort: return (unsigned short)va_arg(*arguments, unsigned);
+    case lengthLong: return va_arg(*arguments, unsigned long);
+    case lengthLongLong: return va_arg(*arguments, unsigned long long);
+    case lengthMax: return va_arg(*arguments, uintmax_t);
+    case lengthSize: return va_arg(*arguments, size_t);
+    case lengthPtrdiff: return va_arg(*arguments, ptrdiff_t);
+    default: return va_arg(*arguments, unsigned);
+    }
+}
+
+// rebuilds one conversion spec with width and precision resolved, for libc
+static void buildSpec(const formatSegment_t* segment, int width, int precision, const char* length, char spec[64]) {
+    char* specPtr = spec;
+    *specPtr++ = '%';
+    if (segment->flags & flagLeft) *specPtr++ = '-';
+    if (segment->flags & flagZero) *specPtr++ = '0';
+    if (segment->flags & flagPlus) *specPtr++ = '+';
+    if (segment->flags & flagSpace) *specPtr++ = ' ';
+    if (segment->flags & flagAlternate) *specPtr++ = '#';
+    if (width >= 0) specPtr += fillBuffer(uitodec(width), specPtr);
+    if (precision >= 0) {
+        *specPtr++ = '.';
+        specPtr += fillBuffer(uitodec(precision), specPtr);
+    }
+    strcpy(specPtr, length);
+    specPtr += strlen(length);
+    *specPtr++ = segment->conversion;
+    *specPtr = '\0';
+}
+
+static void emitFallback(output_t* out, const formatSegment_t* segment, int width, int precision, va_list* arguments) {
+    char spec[64];
+    char* target = out->position < out->capacity ? out->buffer + out->position : NULL;
+    size_t room = out->position < out->capacity ? out->capacity - out->position + 1 : 0;
+    int written = 0;
+
+    switch (segment->conversion) {
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        buildSpec(segment, width, precision, lengthModifiers[segment->length == lengthLongDouble ? lengthLongDouble : lengthNone], spec);
+        if (segment->length == lengthLongDouble) written = snprintf(target, room, spec, va_arg(*arguments, long double));
+        else written = snprintf(target, room, spec, va_arg(*arguments, double));
+        break;
+    case 'c':
+        buildSpec(segment, width, precision, segment->length == lengthLong ? "l" : "", spec);
+        if (segment->length == lengthLong) written = snprintf(target, room, spec, va_arg(*arguments, wint_t));
+        else written = snprintf(target, room, spec, va_arg(*arguments, int));
+        break;
+    case 's':
+        buildSpec(segment, width, precision, segment->length == lengthLong ? "l" : "", spec);
+        if (segment->length == lengthLong) written = snprintf(target, room, spec, va_arg(*arguments, wchar_t*));
+        else written = snprintf(target, room, spec, va_arg(*arguments, char*));
+        break;
+    case 'p':
+        buildSpec(segment, width, precision, "", spec);
+        written = snprintf(target, room, spec, va_arg(*arguments, void*));
+        break;
+    case 'x': case 'X': case 'o':
+        buildSpec(segment, width, precision, "ll", spec);
+        written = snprintf(target, room, spec, (unsigned long long)unsignedArgument(segment->length, arguments));
+        break;
+    case 'n':
+        (void)va_arg(*arguments, void*);
+        break;
+    default:
+        // unknown conversion: print it back the way printf implementations commonly do
+        emit(out, "%", 1);
+        emit(out, &segment->conversion, 1);
+        return;
+    }
+    if (written > 0) out->position += written;
+}
+
+int tp_vsnprintf_compiled(char* buffer, size_t size, const compiledFormat_t* compiled, va_list arguments) {
+    output_t out = {buffer, size ? size - 1 : 0, 0};
+    int overflowed = 0;
+    va_list args;
+    va_copy(args, arguments);
+
+    for (int s = 0; s < compiled->segmentCount; s++) {
+        const formatSegment_t* segment = &compiled->segments[s];
+        int width = segment->width, precision = segment->precision;
+        formatSegment_t adjusted;
+
+        emit(&out, compiled->text + segment->literalStart, segment->literalLength);
+        if (!segment->conversion) continue;
+        if (width == tooLarge || precision == tooLarge) {
+            overflowed = 1;
+            break;
+        }
+
+        if (width == fromArgument) {
+            width = va_arg(args, int);
+            if (width < 0) {
+                // a negative '*' width means left-justify
+                adjusted = *segment;
+                adjusted.flags |= flagLeft;
+                segment = &adjusted;
+                width = width == INT_MIN ? INT_MAX : -width;
+            }
+        }
+        if (precision == fromArgument) {
+            precision = va_arg(args, int);
+            if (precision < 0) precision = notGiven;
+        }
+
+        switch (segment->conversion) {
+        case 'd': case 'i': {
+            int64_t value = signedArgument(segment->length, &args);
+            uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+            emitInteger(&out, segment, width, precision, magnitude, value < 0, 1);
+            break;
+        }
+        case 'u':
+            emitInteger(&out, segment, width, precision, unsignedArgument(segment->length, &args), 0, 0);
+            break;
+        case 's':
+            if (width < 0 && precision < 0 && segment->length == lengthNone) {
+                const char* text = va_arg(args, const char*);
+                if (!text) text = "(null)";
+                emit(&out, text, strlen(text));
+                break;
+            }
+            emitFallback(&out, segment, width, precision, &args);
+            break;
+        default:
+            emitFallback(&out, segment, width, precision, &args);
+        }
+    }
+    va_end(args);
+
+    if (size) buffer[out.position < out.capacity ? out.position : out.capacity] = '\0';
+    if (overflowed || out.position > INT_MAX) {
+        errno = EOVERFLOW; // as printf does when the length doesn't fit its return type
+        return -1;
+    }
+    return out.position;
+}
+
+int tp_snprintf_compiled(char* buffer, size_t size, const compiledFormat_t* compiled, ...) {
+    va_list arguments;
+    int length;
+    va_start(arguments, compiled);
+    length = tp_vsnprintf_compiled(buffer, size, compiled, arguments);
+    va_end(arguments);
+    return length;
+}
+
+/* ---- per-thread cache of compiled formats ---- */
+
+#define cacheSize 64
+
+typedef struct {
+    const char* key;
+    compiledFormat_t* compiled;
+} cacheEntry_t;
+
+static _Thread_local cacheEntry_t formatCache[cacheSize];
+static _Thread_local int cacheRegistered;
+static pthread_key_t cacheKey;
+static pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+// runs at thread exit with the thread's own formatCache
+static void freeCache(void* cache) {
+    cacheEntry_t* entries = cache;
+    for (int slot = 0; slot < cacheSize; slot++) {
+        tp_format_free(entries[slot].compiled);
+        entries[slot].compiled = NULL;
+    }
+}
+
+static void createCacheKey(void) {
+    pthread_key_create(&cacheKey, freeCache);
+}
+
+static const compiledFormat_t* cachedFormat(const char* format) {
+    size_t slot = ((uintptr_t)format >> 3) % cacheSize;
+    compiledFormat_t* compiled = formatCache[slot].compiled;
+
+    // strncmp stops at the end of `format`, which may now be shorter than the cached text
+    if (compiled && formatCache[slot].key == format && !strncmp(compiled->text, format, compiled->textLength + 1)) {
+        return compiled;
+    }
+    if (!cacheRegistered) {
+        pthread_once(&cacheKeyOnce, createCacheKey);
+        cacheRegistered = !pthread_setspecific(cacheKey, formatCache);
+    }
+    tp_format_free(compiled);
+    formatCache[slot].key = format;
+    formatCache[slot].compiled = tp_format_compile(format);
+    return formatCache[slot].compiled;
+}
+
+int tp_vsnprintf(char* buffer, size_t size, const char* format, va_list arguments) {
+    const compiledFormat_t* compiled = cachedFormat(format);
+    if (!compiled) return vsnprintf(buffer, size, format, arguments);
+    return tp_vsnprintf_compiled(buffer, size, compiled, arguments);
+}
+
+int tp_snprintf(char* buffer, size_t size, const char* format, ...) {
+    va_list arguments;
+    int length;
+    va_start(arguments, format);
+    length = tp_vsnprintf(buffer, size, format, arguments);
+    va_end(arguments);
+    return length;
+}
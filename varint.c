@@ -0,0 +1,91 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "toothpaste.h"
+#include "toothpaste_core.h"
+
+/*
+ * LEB128 varints (protobuf's encoding) decoded and formatted in one step, without assembling the binary value.
+ *
+ * Each varint byte carries 7 bits of the value, least significant group first. Group g with payload p
+ * contributes p << 7g, so instead of shifting it into place we look up the decimal of p << 7g in groupROM[g][p]
+ * and add that to the accumulator directly. Every entry is squeezed (all slots 0-9) and a varint has at most ten
+ * groups, so no slot goes past 90 and one squeeze at the end is enough.
+ *
+ * 10 x 128 entries are too many to write out like decimalROM; they're summed from decimalROM64 on first use.
+ * The tenth group holds only bit 63, so a payload above 1 there (or an eleventh byte) is rejected as overlong.
+ */
+
+#define maxGroups 10
+
+static fullDecimal64_t groupROM[maxGroups][128];
+static pthread_once_t groupROMOnce = PTHREAD_ONCE_INIT;
+
+static void buildGroupROM(void) {
+    for (int group = 0; group < maxGroups; group++) {
+        for (int payload = 0; payload < 128; payload++) {
+            fullDecimal64_t entry = {.arith = {0, 0, 0}};
+            for (int bit = 0; bit < 7; bit++) {
+                int position = group * 7 + bit;
+                if (!(payload & (1 << bit)) || position > 63) continue;
+                entry.arith.high += decimalROM64[63 - position].arith.high;
+                entry.arith.mid += decimalROM64[63 - position].arith.mid;
+                entry.arith.low += decimalROM64[63 - position].arith.low;
+            }
+            squeeze64(&entry, quotients, remainders);
+            groupROM[group][payload] = entry;
+        }
+    }
+}
+
+// decodes one varint into `decimal`; returns the bytes it used, or -1 if it is truncated or overlong
+static int decodeToDecimal(const uint8_t* in, size_t available, fullDecimal64_t* decimal) {
+    fullDecimal64_t accumulator = {.arith = {0, 0, 0}};
+    for (int group = 0; group < maxGroups && (size_t)group < available; group++) {
+        uint8_t byte = in[group];
+        const fullDecimal64_t* addend = &groupROM[group][byte & 0x7f];
+        if (group == maxGroups - 1 && byte > 1) return -1;
+        accumulator.arith.high += addend->arith.high;
+        accumulator.arith.mid += addend->arith.mid;
+        accumulator.arith.low += addend->arith.low;
+        if (!(byte & 0x80)) {
+            squeeze64(&accumulator, quotients, remainders);
+            *decimal = accumulator;
+            return group + 1;
+        }
+    }
+    return -1;
+}
+
+int tp_varint_format(const uint8_t* in, size_t available, size_t* consumed, char* out) {
+    fullDecimal64_t decimal;
+    int used;
+    pthread_once(&groupROMOnce, buildGroupROM);
+    used = decodeToDecimal(in, available, &decimal);
+    if (used < 0) return -1;
+    *consumed = used;
+    return fillBuffer64(decimal, out);
+}
+
+int64_t tp_varint_format_batch(const uint8_t* in, size_t size, size_t* consumed, char* out, size_t capacity, char separator) {
+    size_t inPtr = 0;
+    char* bufferPtr = out;
+    char* end = out + capacity;
+    pthread_once(&groupROMOnce, buildGroupROM);
+
+    // fillBuffer64 writes up to 20 digits and a terminator, which the separator then replaces
+    while (inPtr < size && end - bufferPtr >= 21) {
+        fullDecimal64_t decimal;
+        int used = decodeToDecimal(in + inPtr, size - inPtr, &decimal);
+        if (used < 0) {
+            *consumed = inPtr;
+            return -1;
+        }
+        inPtr += used;
+        bufferPtr += fillBuffer64(decimal, bufferPtr);
+        *bufferPtr++ = separator;
+    }
+    *consumed = inPtr;
+    return bufferPtr - out;
+}